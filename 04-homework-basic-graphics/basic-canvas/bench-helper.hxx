@@ -0,0 +1,87 @@
+#pragma once
+
+#include "my-basic-canvas.hxx"
+#include "simd-level.hxx"
+
+//
+#include <glog/logging.h>
+
+//
+#include <string_view>
+#include <chrono>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Helpers shared by the benchmarks of the canvas, the PPM codec and the
+// renders.
+
+namespace arci {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Levels from scalar up to the widest one the CPU supports.
+inline std::vector<simd_level> get_supported_simd_levels() {
+  std::vector<simd_level> result{};
+
+  for (const simd_level level :
+       {simd_level::scalar, simd_level::sse2, simd_level::avx2}) {
+    if (is_simd_level_supported(level)) {
+      result.push_back(level);
+    }
+  }
+
+  return result;
+}
+
+// Calls `run()` until both `min_seconds` have passed and `min_runs` are
+// done, so short operations are averaged over many runs and long ones
+// still run a few times. Returns seconds per run.
+template <typename Run>
+double get_seconds_per_run(
+    const double min_seconds,
+    const size_t min_runs,
+    Run&& run) {
+  using clock = std::chrono::steady_clock;
+
+  size_t runs{};
+  const clock::time_point start = clock::now();
+  std::chrono::duration<double> elapsed{};
+
+  while (runs < min_runs || elapsed.count() < min_seconds) {
+    run();
+    ++runs;
+    elapsed = clock::now() - start;
+  }
+
+  return elapsed.count() / runs;
+}
+
+// Calls `draw(level)` for every supported SIMD level. Each level has to
+// leave the same pixels in `canvas` as the scalar code, `name` tells
+// what was drawn when they differ.
+template <typename Pixel, typename Draw>
+void check_simd_levels_match_scalar(
+    const basic_canvas<Pixel>& canvas,
+    const std::string_view name,
+    Draw&& draw) {
+  typename basic_canvas<Pixel>::pixels scalar_pixels{};
+
+  for (const simd_level level : get_supported_simd_levels()) {
+    draw(level);
+
+    if (level == simd_level::scalar) {
+      scalar_pixels = canvas.get_pixels();
+    } else {
+      CHECK(canvas.get_pixels() == scalar_pixels)
+          << get_simd_level_name(level) << " pixels differ from scalar"
+          << " ones for " << name;
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,209 @@
+#include "bench-helper.hxx"
+#include "my-basic-canvas.hxx"
+
+//
+#include <glog/logging.h>
+
+//
+#include <string_view>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct resolution {
+  std::string_view name{};
+  size_t width{};
+  size_t height{};
+};
+
+template <typename Pixel>
+struct operation {
+  std::string_view name{};
+  // Bytes read and written by one run.
+  size_t bytes{};
+  std::function<void(arci::basic_canvas<Pixel>&)> run{};
+  // Copies go through `std::memmove`, which picks SIMD code on its own,
+  // so they don't depend on the level of the canvas.
+  bool has_kernels{true};
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Operations are run until both limits are reached.
+constexpr double k_min_seconds{0.2};
+constexpr size_t k_min_runs{3};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Alpha goes through every value, 0 and 255 included.
+template <typename Pixel>
+static Pixel get_test_pixel(const size_t i, const size_t j) {
+  if constexpr (std::is_same_v<Pixel, arci::rgba_color>) {
+    return Pixel{
+        static_cast<unsigned char>(i),
+        static_cast<unsigned char>(j),
+        static_cast<unsigned char>(i + j),
+        static_cast<unsigned char>(i * 7 + j),
+    };
+  } else {
+    return Pixel{
+        static_cast<unsigned char>(i),
+        static_cast<unsigned char>(j),
+        static_cast<unsigned char>(i + j),
+    };
+  }
+}
+
+template <typename Pixel>
+static arci::basic_canvas<Pixel> get_test_canvas(
+    const resolution& r,
+    const size_t seed) {
+  arci::basic_canvas<Pixel> result{r.width, r.height, "P6"};
+
+  for (size_t j = 0; j < r.height; ++j) {
+    for (size_t i = 0; i < r.width; ++i) {
+      result.set_color_for_pixel(i, j, get_test_pixel<Pixel>(i + seed, j));
+    }
+  }
+
+  return result;
+}
+
+// Odd borders and size, so kernels go through their unaligned heads and
+// tails on every row.
+static arci::canvas_rect get_inner_rect(const resolution& r) {
+  return arci::canvas_rect{
+      r.width / 8 + 3,
+      r.height / 8 + 1,
+      r.width * 3 / 4 - 5,
+      r.height * 3 / 4 - 3,
+  };
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename Pixel>
+static void run_operation(
+    const resolution& r,
+    const std::string_view format_name,
+    const operation<Pixel>& o,
+    arci::basic_canvas<Pixel>& canvas) {
+  const std::string_view code_name = o.has_kernels
+      ? arci::get_simd_level_name(canvas.get_simd_level())
+      : "memmove";
+
+  const double seconds_per_run = arci::get_seconds_per_run(
+      k_min_seconds,
+      k_min_runs,
+      [&]() { o.run(canvas); });
+
+  std::cout << std::left << std::setw(8) << r.name
+            << std::setw(8) << format_name
+            << std::setw(12) << o.name
+            << std::setw(8) << code_name
+            << std::right << std::fixed << std::setprecision(3)
+            << std::setw(10) << seconds_per_run * 1e3
+            << std::setw(10) << std::setprecision(2)
+            << o.bytes / seconds_per_run / 1e9 << "\n";
+}
+
+template <typename Pixel>
+static void run_format(
+    const resolution& r,
+    const std::string_view format_name) {
+  const arci::basic_canvas<Pixel> base = get_test_canvas<Pixel>(r, 0);
+  const arci::basic_canvas<Pixel> source = get_test_canvas<Pixel>(r, 100);
+  const arci::canvas_rect rect = get_inner_rect(r);
+  const size_t canvas_bytes = r.width * r.height * sizeof(Pixel);
+  const size_t rect_bytes = rect.width * rect.height * sizeof(Pixel);
+  const Pixel value = get_test_pixel<Pixel>(10, 20);
+
+  std::vector<operation<Pixel>> operations{
+      {"clear",
+       canvas_bytes,
+       [&](arci::basic_canvas<Pixel>& canvas) {
+         canvas.fill_all_with_color(value);
+       }},
+      {"fill-rect",
+       rect_bytes,
+       [&](arci::basic_canvas<Pixel>& canvas) {
+         canvas.fill_rect(rect, value);
+       }},
+      {"copy-rect",
+       2 * rect_bytes,
+       [&](arci::basic_canvas<Pixel>& canvas) {
+         canvas.copy_rect(source, rect, rect.x + 1, rect.y + 2);
+       },
+       false},
+  };
+
+  if constexpr (std::is_same_v<Pixel, arci::rgba_color>) {
+    operations.push_back(
+        {"blend-rect",
+         3 * rect_bytes,
+         [&](arci::basic_canvas<Pixel>& canvas) {
+           arci::blend_rect(canvas, source, rect, rect.x + 1, rect.y + 2);
+         }});
+  }
+
+  arci::basic_canvas<Pixel> canvas{};
+
+  for (const operation<Pixel>& o : operations) {
+    if (o.has_kernels) {
+      const std::string name = std::string{o.name} + " of "
+          + std::string{format_name} + " " + std::string{r.name};
+
+      arci::check_simd_levels_match_scalar(
+          canvas,
+          name,
+          [&](const arci::simd_level level) {
+            canvas = base;
+            canvas.set_simd_level(level);
+            o.run(canvas);
+          });
+    }
+
+    for (const arci::simd_level level : arci::get_supported_simd_levels()) {
+      if (!o.has_kernels && level != arci::simd_level::scalar) {
+        continue;
+      }
+
+      canvas = base;
+      canvas.set_simd_level(level);
+      run_operation(r, format_name, o, canvas);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int, char** argv) {
+  FLAGS_logtostderr = true;
+  google::InitGoogleLogging(argv[0]);
+
+  const std::vector<resolution> resolutions{
+      {"1080p", 1920, 1080},
+      {"4k", 3840, 2160},
+  };
+
+  std::cout << std::left << std::setw(8) << "size"
+            << std::setw(8) << "format"
+            << std::setw(12) << "operation"
+            << std::setw(8) << "code"
+            << std::right << std::setw(10) << "ms/op"
+            << std::setw(10) << "GB/s" << "\n";
+
+  for (const resolution& r : resolutions) {
+    run_format<arci::color>(r, "rgb24");
+    run_format<arci::rgba_color>(r, "rgba8");
+  }
+
+  return EXIT_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,337 @@
+#include "canvas-kernels.hxx"
+
+//
+#include <glog/logging.h>
+
+//
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// See simd-level.hxx on how the SIMD kernels are built.
+#ifdef ARCI_X86_SIMD
+#include <immintrin.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci {
+
+///////////////////////////////////////////////////////////////////////////////
+
+static_assert(
+    sizeof(rgba_color) == 4,
+    "Struct 'arci::rgba_color' should have 32 bits for size");
+
+// Fills bigger than this hardly stay in cache, so their stores bypass it
+// and don't read the lines they are going to overwrite.
+constexpr size_t k_streaming_bytes{size_t{1} << 22};
+
+template <typename Pixel>
+static void fill_scalar(Pixel* pixels, const size_t count, const Pixel& value) {
+  std::fill(pixels, pixels + count, value);
+}
+
+// Rounded division of `source * source_weight + destination *
+// destination_weight` by 255. It is exact for sums up to 255 * 255,
+// with 16 bit operations only.
+static unsigned char get_mixed_channel(
+    const unsigned source,
+    const unsigned source_weight,
+    const unsigned destination,
+    const unsigned destination_weight) {
+  const unsigned sum = source * source_weight
+      + destination * destination_weight + 128;
+  return static_cast<unsigned char>((sum + (sum >> 8)) >> 8);
+}
+
+// Color channels are weighted by source alpha, while source alpha itself
+// is taken whole, which gives `a + destination a * (1 - a)`.
+static void blend_rgba_scalar(
+    rgba_color* destination,
+    const rgba_color* source,
+    const size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    const rgba_color& s = source[i];
+    rgba_color& d = destination[i];
+    const unsigned inverse_alpha = 255 - s.a;
+
+    d.r = get_mixed_channel(s.r, s.a, d.r, inverse_alpha);
+    d.g = get_mixed_channel(s.g, s.a, d.g, inverse_alpha);
+    d.b = get_mixed_channel(s.b, s.a, d.b, inverse_alpha);
+    d.a = get_mixed_channel(s.a, 255, d.a, inverse_alpha);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef ARCI_X86_SIMD
+
+// Number of first pixels to skip, so the rest start at a multiple of
+// `alignment` bytes. 3 byte pixels get there in fewer than `alignment`
+// steps as well.
+template <typename Pixel>
+static size_t get_head_count(
+    const Pixel* pixels,
+    const size_t count,
+    const size_t alignment) {
+  size_t result{};
+  while (result < count
+         && reinterpret_cast<uintptr_t>(pixels + result) % alignment != 0) {
+    ++result;
+  }
+  return result;
+}
+
+// `sizeof(Pixel)` vectors hold a whole number of pixels, so the same
+// vectors are stored over and over from the first aligned pixel on.
+template <typename Pixel, size_t vector_size>
+static void fill_pattern(
+    const Pixel& value,
+    unsigned char (&pattern)[sizeof(Pixel) * vector_size]) {
+  for (size_t k = 0; k < vector_size; ++k) {
+    std::memcpy(pattern + k * sizeof(Pixel), &value, sizeof(Pixel));
+  }
+}
+
+template <typename Pixel>
+__attribute__((target("sse2"))) static void fill_sse2(
+    Pixel* pixels,
+    const size_t count,
+    const Pixel& value) {
+  constexpr size_t k_vector_size{16};
+  constexpr size_t k_vectors{sizeof(Pixel)};
+
+  alignas(k_vector_size) unsigned char bytes[k_vectors * k_vector_size];
+  fill_pattern<Pixel, k_vector_size>(value, bytes);
+
+  __m128i pattern[k_vectors];
+  for (size_t k = 0; k < k_vectors; ++k) {
+    pattern[k] = _mm_load_si128(
+        reinterpret_cast<const __m128i*>(bytes + k * k_vector_size));
+  }
+
+  size_t i = get_head_count(pixels, count, k_vector_size);
+  std::fill(pixels, pixels + i, value);
+
+  if (count * sizeof(Pixel) >= k_streaming_bytes) {
+    for (; i + k_vector_size <= count; i += k_vector_size) {
+      __m128i* destination = reinterpret_cast<__m128i*>(pixels + i);
+      for (size_t k = 0; k < k_vectors; ++k) {
+        _mm_stream_si128(destination + k, pattern[k]);
+      }
+    }
+    _mm_sfence();
+  } else {
+    for (; i + k_vector_size <= count; i += k_vector_size) {
+      __m128i* destination = reinterpret_cast<__m128i*>(pixels + i);
+      for (size_t k = 0; k < k_vectors; ++k) {
+        _mm_store_si128(destination + k, pattern[k]);
+      }
+    }
+  }
+
+  std::fill(pixels + i, pixels + count, value);
+}
+
+__attribute__((target("sse2"))) static void blend_half_sse2(
+    const __m128i& source,
+    const __m128i& destination,
+    __m128i& result) {
+  const __m128i max = _mm_set1_epi16(255);
+  const __m128i rounding = _mm_set1_epi16(128);
+  const __m128i alpha_lanes = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+
+  const __m128i alpha = _mm_shufflehi_epi16(
+      _mm_shufflelo_epi16(source, _MM_SHUFFLE(3, 3, 3, 3)),
+      _MM_SHUFFLE(3, 3, 3, 3));
+  const __m128i source_weight = _mm_or_si128(alpha, alpha_lanes);
+  const __m128i destination_weight = _mm_sub_epi16(max, alpha);
+
+  const __m128i sum = _mm_add_epi16(
+      _mm_add_epi16(
+          _mm_mullo_epi16(source, source_weight),
+          _mm_mullo_epi16(destination, destination_weight)),
+      rounding);
+  result = _mm_srli_epi16(_mm_add_epi16(sum, _mm_srli_epi16(sum, 8)), 8);
+}
+
+// 4 pixels at once, 2 of them in 16 bit lanes per half.
+__attribute__((target("sse2"))) static void blend_rgba_sse2(
+    rgba_color* destination,
+    const rgba_color* source,
+    const size_t count) {
+  constexpr size_t k_lanes{4};
+
+  const __m128i zero = _mm_setzero_si128();
+
+  size_t i{};
+  for (; i + k_lanes <= count; i += k_lanes) {
+    __m128i* d = reinterpret_cast<__m128i*>(destination + i);
+    const __m128i s_pixels =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+    const __m128i d_pixels = _mm_loadu_si128(d);
+
+    __m128i low, high;
+    blend_half_sse2(
+        _mm_unpacklo_epi8(s_pixels, zero),
+        _mm_unpacklo_epi8(d_pixels, zero),
+        low);
+    blend_half_sse2(
+        _mm_unpackhi_epi8(s_pixels, zero),
+        _mm_unpackhi_epi8(d_pixels, zero),
+        high);
+
+    _mm_storeu_si128(d, _mm_packus_epi16(low, high));
+  }
+
+  blend_rgba_scalar(destination + i, source + i, count - i);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename Pixel>
+__attribute__((target("avx2"))) static void fill_avx2(
+    Pixel* pixels,
+    const size_t count,
+    const Pixel& value) {
+  constexpr size_t k_vector_size{32};
+  constexpr size_t k_vectors{sizeof(Pixel)};
+
+  alignas(k_vector_size) unsigned char bytes[k_vectors * k_vector_size];
+  fill_pattern<Pixel, k_vector_size>(value, bytes);
+
+  __m256i pattern[k_vectors];
+  for (size_t k = 0; k < k_vectors; ++k) {
+    pattern[k] = _mm256_load_si256(
+        reinterpret_cast<const __m256i*>(bytes + k * k_vector_size));
+  }
+
+  size_t i = get_head_count(pixels, count, k_vector_size);
+  std::fill(pixels, pixels + i, value);
+
+  if (count * sizeof(Pixel) >= k_streaming_bytes) {
+    for (; i + k_vector_size <= count; i += k_vector_size) {
+      __m256i* destination = reinterpret_cast<__m256i*>(pixels + i);
+      for (size_t k = 0; k < k_vectors; ++k) {
+        _mm256_stream_si256(destination + k, pattern[k]);
+      }
+    }
+    _mm_sfence();
+  } else {
+    for (; i + k_vector_size <= count; i += k_vector_size) {
+      __m256i* destination = reinterpret_cast<__m256i*>(pixels + i);
+      for (size_t k = 0; k < k_vectors; ++k) {
+        _mm256_store_si256(destination + k, pattern[k]);
+      }
+    }
+  }
+
+  std::fill(pixels + i, pixels + count, value);
+}
+
+__attribute__((target("avx2"))) static void blend_half_avx2(
+    const __m256i& source,
+    const __m256i& destination,
+    __m256i& result) {
+  const __m256i max = _mm256_set1_epi16(255);
+  const __m256i rounding = _mm256_set1_epi16(128);
+  const __m256i alpha_lanes = _mm256_setr_epi16(
+      0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+
+  const __m256i alpha = _mm256_shufflehi_epi16(
+      _mm256_shufflelo_epi16(source, _MM_SHUFFLE(3, 3, 3, 3)),
+      _MM_SHUFFLE(3, 3, 3, 3));
+  const __m256i source_weight = _mm256_or_si256(alpha, alpha_lanes);
+  const __m256i destination_weight = _mm256_sub_epi16(max, alpha);
+
+  const __m256i sum = _mm256_add_epi16(
+      _mm256_add_epi16(
+          _mm256_mullo_epi16(source, source_weight),
+          _mm256_mullo_epi16(destination, destination_weight)),
+      rounding);
+  result = _mm256_srli_epi16(
+      _mm256_add_epi16(sum, _mm256_srli_epi16(sum, 8)),
+      8);
+}
+
+// 8 pixels at once. Unpacking and packing work within 128 bit halves,
+// so pixels come back in their order.
+__attribute__((target("avx2"))) static void blend_rgba_avx2(
+    rgba_color* destination,
+    const rgba_color* source,
+    const size_t count) {
+  constexpr size_t k_lanes{8};
+
+  const __m256i zero = _mm256_setzero_si256();
+
+  size_t i{};
+  for (; i + k_lanes <= count; i += k_lanes) {
+    __m256i* d = reinterpret_cast<__m256i*>(destination + i);
+    const __m256i s_pixels =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+    const __m256i d_pixels = _mm256_loadu_si256(d);
+
+    __m256i low, high;
+    blend_half_avx2(
+        _mm256_unpacklo_epi8(s_pixels, zero),
+        _mm256_unpacklo_epi8(d_pixels, zero),
+        low);
+    blend_half_avx2(
+        _mm256_unpackhi_epi8(s_pixels, zero),
+        _mm256_unpackhi_epi8(d_pixels, zero),
+        high);
+
+    _mm256_storeu_si256(d, _mm256_packus_epi16(low, high));
+  }
+
+  blend_rgba_sse2(destination + i, source + i, count - i);
+}
+
+#endif // ARCI_X86_SIMD
+
+///////////////////////////////////////////////////////////////////////////////
+
+constexpr canvas_kernels k_scalar_kernels{
+    fill_scalar<color>,
+    fill_scalar<rgba_color>,
+    blend_rgba_scalar,
+};
+
+#ifdef ARCI_X86_SIMD
+
+constexpr canvas_kernels k_sse2_kernels{
+    fill_sse2<color>,
+    fill_sse2<rgba_color>,
+    blend_rgba_sse2,
+};
+
+constexpr canvas_kernels k_avx2_kernels{
+    fill_avx2<color>,
+    fill_avx2<rgba_color>,
+    blend_rgba_avx2,
+};
+
+#endif // ARCI_X86_SIMD
+
+const canvas_kernels& get_canvas_kernels(const simd_level level) {
+  CHECK(is_simd_level_supported(level))
+      << "CPU doesn't support " << get_simd_level_name(level);
+
+  switch (level) {
+#ifdef ARCI_X86_SIMD
+    case simd_level::avx2:
+      return k_avx2_kernels;
+    case simd_level::sse2:
+      return k_sse2_kernels;
+#endif
+    default:
+      return k_scalar_kernels;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci
+
+///////////////////////////////////////////////////////////////////////////////
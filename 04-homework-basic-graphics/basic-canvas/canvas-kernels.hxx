@@ -0,0 +1,36 @@
+#pragma once
+
+#include "my-basic-canvas.hxx"
+#include "simd-level.hxx"
+
+//
+#include <cstddef>
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Kernels working on contiguous pixels, such as a row of a canvas. Every
+// level gives exactly the same pixels as the scalar one.
+struct canvas_kernels {
+  void (*fill_rgb)(color* pixels, const size_t count, const color& value);
+  void (*fill_rgba)(
+      rgba_color* pixels,
+      const size_t count,
+      const rgba_color& value);
+  // Mixes `source` over `destination` as `arci::blend_rect` describes.
+  void (*blend_rgba)(
+      rgba_color* destination,
+      const rgba_color* source,
+      const size_t count);
+};
+
+const canvas_kernels& get_canvas_kernels(const simd_level level);
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci
+
+///////////////////////////////////////////////////////////////////////////////
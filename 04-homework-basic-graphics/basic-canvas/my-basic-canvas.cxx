@@ -1,4 +1,6 @@
 #include "my-basic-canvas.hxx"
+#include "canvas-kernels.hxx"
+#include "ppm-codec.hxx"
 
 //
 #include <glog/logging.h>
@@ -6,9 +8,9 @@
 //
 #include <string_view>
 #include <algorithm>
-#include <cctype> // For isspace().
-#include <fstream>
+#include <cstring>
 #include <string>
+#include <type_traits>
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -33,6 +35,21 @@ std::ostream& operator<<(std::ostream& os, const color& color) {
   return os;
 }
 
+bool operator==(const rgba_color& color1, const rgba_color& color2) {
+  return color1.r == color2.r
+      && color1.g == color2.g
+      && color1.b == color2.b
+      && color1.a == color2.a;
+}
+
+std::ostream& operator<<(std::ostream& os, const rgba_color& color) {
+  os << "r = " << static_cast<int>(color.r)
+     << "\tg = " << static_cast<int>(color.g)
+     << "\tb = " << static_cast<int>(color.b)
+     << "\ta = " << static_cast<int>(color.a);
+  return os;
+}
+
 std::ostream& operator<<(std::ostream& os, const std::vector<color>& pixels) {
   std::for_each(
       pixels.begin(),
@@ -49,7 +66,46 @@ std::ostream& operator<<(std::ostream& os, const std::vector<color>& pixels) {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-my_canvas::my_canvas(
+// PPM images keep RGB24 pixels, RGBA ones are converted.
+static rgba_color get_rgba_color(const color& c) {
+  return rgba_color{c.r, c.g, c.b};
+}
+
+static color get_color(const rgba_color& c) {
+  return color{c.r, c.g, c.b};
+}
+
+static void fill_pixels(
+    const canvas_kernels& kernels,
+    color* pixels,
+    const size_t count,
+    const color& value) {
+  kernels.fill_rgb(pixels, count, value);
+}
+
+static void fill_pixels(
+    const canvas_kernels& kernels,
+    rgba_color* pixels,
+    const size_t count,
+    const rgba_color& value) {
+  kernels.fill_rgba(pixels, count, value);
+}
+
+static void check_rect(
+    const canvas_rect& rect,
+    const size_t width,
+    const size_t height) {
+  CHECK(rect.width <= width && rect.x <= width - rect.width
+        && rect.height <= height && rect.y <= height - rect.height)
+      << "Rectangle " << rect.width << "x" << rect.height << " at ("
+      << rect.x << ", " << rect.y << ") is out of " << width << "x"
+      << height << " canvas";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename Pixel>
+basic_canvas<Pixel>::basic_canvas(
     const size_t width,
     const size_t height,
     const std::string& format)
@@ -59,20 +115,95 @@ my_canvas::my_canvas(
   m_pixels.resize(width * height);
 }
 
-std::vector<color>& my_canvas::get_pixels() noexcept {
+template <typename Pixel>
+typename basic_canvas<Pixel>::pixels&
+basic_canvas<Pixel>::get_pixels() noexcept {
   return m_pixels;
 }
 
-void my_canvas::fill_all_with_color(const color& some_color) {
-  std::for_each(m_pixels.begin(), m_pixels.end(), [&some_color](color& c) {
-    c = some_color;
-  });
+template <typename Pixel>
+const typename basic_canvas<Pixel>::pixels&
+basic_canvas<Pixel>::get_pixels() const noexcept {
+  return m_pixels;
+}
+
+template <typename Pixel>
+void basic_canvas<Pixel>::fill_all_with_color(const Pixel& some_color) {
+  fill_pixels(
+      get_canvas_kernels(m_simd_level),
+      m_pixels.data(),
+      m_pixels.size(),
+      some_color);
+}
+
+template <typename Pixel>
+void basic_canvas<Pixel>::fill_rect(
+    const canvas_rect& rect,
+    const Pixel& some_color) {
+  check_rect(rect, m_width, m_height);
+
+  const canvas_kernels& kernels = get_canvas_kernels(m_simd_level);
+
+  // Rows as wide as the canvas are filled at once.
+  if (rect.width == m_width) {
+    fill_pixels(
+        kernels,
+        m_pixels.data() + rect.y * m_width,
+        rect.height * m_width,
+        some_color);
+    return;
+  }
+
+  for (size_t j = rect.y; j < rect.y + rect.height; ++j) {
+    fill_pixels(
+        kernels,
+        m_pixels.data() + j * m_width + rect.x,
+        rect.width,
+        some_color);
+  }
+}
+
+template <typename Pixel>
+void basic_canvas<Pixel>::copy_rect(
+    const basic_canvas& source,
+    const canvas_rect& source_rect,
+    const size_t x,
+    const size_t y) {
+  check_rect(source_rect, source.m_width, source.m_height);
+  check_rect(
+      canvas_rect{x, y, source_rect.width, source_rect.height},
+      m_width,
+      m_height);
+
+  // Rows as wide as both canvases are contiguous.
+  if (source_rect.width == m_width && source_rect.width == source.m_width) {
+    std::memmove(
+        m_pixels.data() + y * m_width,
+        source.m_pixels.data() + source_rect.y * m_width,
+        source_rect.height * m_width * sizeof(Pixel));
+    return;
+  }
+
+  // Rows are moved, not copied, for overlapping rectangles of this
+  // canvas, and bottom up when the copy goes down.
+  const bool is_bottom_up = &source == this && y > source_rect.y;
+  const size_t row_bytes = source_rect.width * sizeof(Pixel);
+
+  for (size_t j = 0; j < source_rect.height; ++j) {
+    const size_t row = is_bottom_up ? source_rect.height - 1 - j : j;
+    std::memmove(
+        m_pixels.data() + (y + row) * m_width + x,
+        source.m_pixels.data()
+            + (source_rect.y + row) * source.m_width + source_rect.x,
+        row_bytes);
+  }
 }
 
-void my_canvas::set_color_for_pixel(
+template <typename Pixel>
+void basic_canvas<Pixel>::set_color_for_pixel(
     const size_t i,
     const size_t j,
-    const color& color) {
+    const Pixel& color) {
   const size_t index = m_width * j + i;
   CHECK(index < m_pixels.size())
       << "Incorrect index for setting color";
@@ -80,153 +211,112 @@ void my_canvas::set_color_for_pixel(
   m_pixels[index] = color;
 }
 
-void my_canvas::set_resolution(const std::pair<size_t, size_t>& resolution) {
+template <typename Pixel>
+void basic_canvas<Pixel>::set_resolution(
+    const std::pair<size_t, size_t>& resolution) {
   m_width = resolution.first;
   m_height = resolution.second;
   m_pixels.resize(m_width * m_height);
 }
 
-size_t my_canvas::get_width() const noexcept {
+template <typename Pixel>
+void basic_canvas<Pixel>::set_simd_level(const simd_level level) {
+  CHECK(is_simd_level_supported(level))
+      << "CPU doesn't support " << get_simd_level_name(level);
+  m_simd_level = level;
+}
+
+template <typename Pixel>
+size_t basic_canvas<Pixel>::get_width() const noexcept {
   return m_width;
 }
 
-size_t my_canvas::get_height() const noexcept {
+template <typename Pixel>
+size_t basic_canvas<Pixel>::get_height() const noexcept {
   return m_height;
 }
 
-std::pair<size_t, size_t> my_canvas::get_resolution() const noexcept {
+template <typename Pixel>
+std::pair<size_t, size_t> basic_canvas<Pixel>::get_resolution() const noexcept {
   return std::make_pair(get_width(), get_height());
 }
 
-void my_canvas::load_ppm_image(const std::string_view name_image) {
-  std::ifstream file{};
-
-  file.exceptions(std::ios_base::failbit);
-  file.open(name_image.data());
-
-  CHECK(file.is_open()) << "Error on opening '"
-                        << name_image << "' for reading";
-
-  uint16_t max_color_value{};
-
-  file >> m_ppm_format;
-
-  CHECK(!m_ppm_format.empty()) << "Invalid ppm format for '"
-                               << name_image << "'";
-
-  CHECK("P3" == m_ppm_format || "P6" == m_ppm_format)
-      << "Function 'load_ppm_image' supports only 'P3' and 'P6' formats";
-
-  LOG(INFO) << "Format read from '" << name_image << "' is: " << m_ppm_format;
-
-  char first_symbol_on_new_line = file.get();
-
-  // Extracts all whitespace symbols. As a result, we should get the
-  // position for symbol which is a beginning for a comment('#') or
-  // int value for triplet column number.
-  auto extracting_whitespaces = [&file, &first_symbol_on_new_line]() {
-    while (isspace(static_cast<unsigned char>(first_symbol_on_new_line))) {
-      first_symbol_on_new_line = file.get();
-    }
-  };
-
-  extracting_whitespaces();
-
-  std::string comments{};
+template <typename Pixel>
+simd_level basic_canvas<Pixel>::get_simd_level() const noexcept {
+  return m_simd_level;
+}
 
-  // Reading all comments.
-  while (first_symbol_on_new_line == '#') {
-    std::string comment{};
-    std::getline(file, comment, '\n');
-    CHECK(file.good());
-    comments += comment + "\n";
-    first_symbol_on_new_line = file.get();
-    CHECK(file.good());
-    extracting_whitespaces();
-  }
+template <typename Pixel>
+void basic_canvas<Pixel>::load_ppm_image(const std::string_view name_image) {
+  ppm_header header{};
 
-  // We've consumed important symbol for reading. So set current file
-  // position to the previous symbol.
-  const std::streampos pos = file.tellg() - static_cast<std::streamoff>(1);
-  file.seekg(pos);
+  if constexpr (std::is_same_v<Pixel, color>) {
+    header = load_ppm(name_image, m_pixels);
+  } else {
+    std::vector<color> image{};
+    header = load_ppm(name_image, image);
 
-  if (!comments.empty()) {
-    LOG(INFO) << comments;
+    m_pixels.resize(image.size());
+    std::transform(
+        image.begin(),
+        image.end(),
+        m_pixels.begin(),
+        get_rgba_color);
   }
 
-  char white_space{};
-
-  file >> m_width
-      >> m_height
-      >> max_color_value
-      >> std::noskipws
-      >> white_space;
-
-  CHECK(isspace(static_cast<unsigned char>(white_space)))
-      << "After max color value should be a whitespace symbol";
-
-  LOG(INFO) << "Width: " << m_width;
-  LOG(INFO) << "Height: " << m_height;
-  LOG(INFO) << "Max color value is: " << max_color_value;
-
-  m_pixels.resize(m_width * m_height);
+  m_ppm_format = header.format;
+  m_width = header.width;
+  m_height = header.height;
+}
 
-  CHECK_EQ(m_pixels.size(), m_width * m_height);
+template <typename Pixel>
+void basic_canvas<Pixel>::save_ppm_image(
+    const std::string_view name_file) const {
+  const ppm_header header{m_ppm_format, m_width, m_height};
 
-  if (m_ppm_format == "P3") {
-    std::for_each(
+  if constexpr (std::is_same_v<Pixel, color>) {
+    save_ppm(name_file, header, m_pixels.data());
+  } else {
+    std::vector<color> image(m_pixels.size());
+    std::transform(
         m_pixels.begin(),
         m_pixels.end(),
-        [&file, r = 0, g = 0, b = 0](color& c) mutable {
-          char white_space{};
-          file >> r >> white_space;
-          CHECK(isspace(static_cast<unsigned char>(white_space)));
-          file >> g >> white_space;
-          CHECK(isspace(static_cast<unsigned char>(white_space)));
-          file >> b >> white_space;
-          CHECK(isspace(static_cast<unsigned char>(white_space)));
-          c.r = static_cast<unsigned char>(r);
-          c.g = static_cast<unsigned char>(g);
-          c.b = static_cast<unsigned char>(b);
-        });
-  } else {
-    const std::streamsize bytes_to_read = sizeof(color) * m_pixels.size();
-    file.read(reinterpret_cast<char*>(m_pixels.data()), bytes_to_read);
+        image.begin(),
+        get_color);
+    save_ppm(name_file, header, image.data());
   }
-
-  file.close();
 }
 
-void my_canvas::save_ppm_image(const std::string_view name_file) const {
-  std::ofstream file{};
-
-  file.exceptions(std::ios_base::failbit);
-  file.open(name_file.data(), std::ios_base::trunc);
-
-  CHECK(file.is_open())
-      << "Error on opening '" << name_file << "' for writing";
-
-  CHECK("P3" == m_ppm_format || "P6" == m_ppm_format)
-      << "Function 'save_ppm_image' supports only 'P3' and 'P6' formats";
+template class basic_canvas<color>;
+template class basic_canvas<rgba_color>;
 
-  uint16_t max_color_value{255};
-
-  file << m_ppm_format << "\n";
-  file << m_width << " " << m_height << "\n";
-  file << max_color_value << "\n";
+///////////////////////////////////////////////////////////////////////////////
 
-  if (m_ppm_format == "P3") {
-    std::for_each(m_pixels.begin(), m_pixels.end(), [&file](const color& c) {
-      file << static_cast<int>(c.r) << " "
-           << static_cast<int>(c.g) << " "
-           << static_cast<int>(c.b) << "\n";
-    });
-  } else {
-    std::streamsize bytes_to_write = sizeof(color) * m_pixels.size();
-    file.write(reinterpret_cast<const char*>(m_pixels.data()), bytes_to_write);
+void blend_rect(
+    rgba_canvas& destination,
+    const rgba_canvas& source,
+    const canvas_rect& source_rect,
+    const size_t x,
+    const size_t y) {
+  CHECK(&destination != &source) << "Can't blend a canvas over itself";
+  check_rect(source_rect, source.get_width(), source.get_height());
+  check_rect(
+      canvas_rect{x, y, source_rect.width, source_rect.height},
+      destination.get_width(),
+      destination.get_height());
+
+  const canvas_kernels& kernels =
+      get_canvas_kernels(destination.get_simd_level());
+  rgba_color* destination_pixels = destination.get_pixels().data();
+  const rgba_color* source_pixels = source.get_pixels().data();
+
+  for (size_t j = 0; j < source_rect.height; ++j) {
+    kernels.blend_rgba(
+        destination_pixels + (y + j) * destination.get_width() + x,
+        source_pixels
+            + (source_rect.y + j) * source.get_width() + source_rect.x,
+        source_rect.width);
   }
-
-  file.close();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
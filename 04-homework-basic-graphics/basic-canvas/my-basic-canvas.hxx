@@ -1,7 +1,13 @@
 #pragma once
 
+#include "simd-level.hxx"
+
+//
 #include <string_view>
+#include <cstddef>
 #include <iosfwd>
+#include <memory>
+#include <new>
 #include <string>
 #include <utility>
 #include <vector>
@@ -12,6 +18,7 @@ namespace arci {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Pixel of PPM images, 24 bits.
 #pragma pack(push, 1)
 struct color {
   unsigned char r{};
@@ -24,47 +31,151 @@ struct color {
 
 std::ostream& operator<<(std::ostream& os, const std::vector<color>& pixels);
 
+// Pixel with alpha, 32 bits. Vectors hold whole pixels of it, so SIMD
+// kernels need no shuffles to load and store them.
+struct alignas(4) rgba_color {
+  unsigned char r{};
+  unsigned char g{};
+  unsigned char b{};
+  unsigned char a{255};
+  friend bool operator==(const rgba_color& color1, const rgba_color& color2);
+  friend std::ostream& operator<<(std::ostream& os, const rgba_color& color);
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
-class my_canvas final {
+// Pixels of RGBA canvases start at a cache line. Rows do too, when their
+// size in bytes is a multiple of it, as for 1080p and 4K canvases.
+constexpr size_t k_canvas_alignment{64};
+
+template <typename T, size_t alignment>
+struct aligned_allocator {
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = aligned_allocator<U, alignment>;
+  };
+
+  aligned_allocator() = default;
+
+  template <typename U>
+  aligned_allocator(const aligned_allocator<U, alignment>&) noexcept {}
+
+  T* allocate(const size_t count) {
+    return static_cast<T*>(
+        ::operator new(count * sizeof(T), std::align_val_t{alignment}));
+  }
+
+  void deallocate(T* pointer, const size_t) noexcept {
+    ::operator delete(pointer, std::align_val_t{alignment});
+  }
+
+  friend bool operator==(const aligned_allocator&, const aligned_allocator&) {
+    return true;
+  }
+
+  friend bool operator!=(const aligned_allocator&, const aligned_allocator&) {
+    return false;
+  }
+};
+
+// Pixel formats a canvas can store. RGB24 pixels stay in a plain
+// `std::vector<color>`, which renders and PPM I/O work with.
+template <typename Pixel>
+struct pixel_format;
+
+template <>
+struct pixel_format<color> {
+  using allocator = std::allocator<color>;
+};
+
+template <>
+struct pixel_format<rgba_color> {
+  using allocator = aligned_allocator<rgba_color, k_canvas_alignment>;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct canvas_rect {
+  size_t x{};
+  size_t y{};
+  size_t width{};
+  size_t height{};
+};
+
+// Fills, copies and blends go through SIMD kernels of the widest level
+// the CPU supports, unless another one is set. All levels give the same
+// pixels.
+template <typename Pixel>
+class basic_canvas final {
  public:
-  ~my_canvas() = default;
-  my_canvas() = default;
-  my_canvas(
+  using pixels = std::vector<Pixel, typename pixel_format<Pixel>::allocator>;
+
+  ~basic_canvas() = default;
+  basic_canvas() = default;
+  basic_canvas(
       const size_t width,
       const size_t height,
       const std::string& format);
-  my_canvas(const my_canvas& other) = default;
-  my_canvas(my_canvas&& other) = default;
-  my_canvas& operator=(const my_canvas& other) = default;
-  my_canvas& operator=(my_canvas&& other) = default;
-
-  std::vector<color>& get_pixels() noexcept;
-  void fill_all_with_color(const color& color);
+  basic_canvas(const basic_canvas& other) = default;
+  basic_canvas(basic_canvas&& other) = default;
+  basic_canvas& operator=(const basic_canvas& other) = default;
+  basic_canvas& operator=(basic_canvas&& other) = default;
+
+  pixels& get_pixels() noexcept;
+  const pixels& get_pixels() const noexcept;
+  void fill_all_with_color(const Pixel& color);
+  void fill_rect(const canvas_rect& rect, const Pixel& color);
+  // Copies `source_rect` of `source` with its top left corner at (x, y).
+  // The source may be this canvas, even with overlapping rectangles.
+  void copy_rect(
+      const basic_canvas& source,
+      const canvas_rect& source_rect,
+      const size_t x,
+      const size_t y);
   void set_color_for_pixel(
       const size_t i,
       const size_t j,
-      const color& color);
+      const Pixel& color);
 
   void set_resolution(const std::pair<size_t, size_t>& resolution);
+  void set_simd_level(const simd_level level);
 
   size_t get_width() const noexcept;
   size_t get_height() const noexcept;
   std::pair<size_t, size_t> get_resolution() const noexcept;
+  simd_level get_simd_level() const noexcept;
 
+  // Images are RGB24, alpha is dropped on saving and opaque on loading.
   void load_ppm_image(const std::string_view name_image);
   void save_ppm_image(const std::string_view name_image) const;
 
  private:
-  std::vector<color> m_pixels{};
+  pixels m_pixels{};
 
   // P3 or P6.
   std::string m_ppm_format{"P6"};
 
   size_t m_width{};
   size_t m_height{};
+
+  simd_level m_simd_level{get_supported_simd_level()};
 };
 
+using my_canvas = basic_canvas<color>;
+using rgba_canvas = basic_canvas<rgba_color>;
+
+// Draws `source_rect` of `source` over `destination` with its top left
+// corner at (x, y). Colors are mixed by source alpha, and the resulting
+// alpha is `a + destination a * (1 - a)`. The canvases must differ.
+void blend_rect(
+    rgba_canvas& destination,
+    const rgba_canvas& source,
+    const canvas_rect& source_rect,
+    const size_t x,
+    const size_t y);
+
 ///////////////////////////////////////////////////////////////////////////////
 
 } // namespace arci
@@ -0,0 +1,102 @@
+#include "bench-helper.hxx"
+#include "my-basic-canvas.hxx"
+
+//
+#include <glog/logging.h>
+
+//
+#include <string_view>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+constexpr size_t k_width{3840};
+constexpr size_t k_height{2160};
+
+constexpr std::string_view k_file_name{"ppm-bench-4k.ppm"};
+
+// Images are saved and loaded until both limits are reached.
+constexpr double k_min_seconds{1.0};
+constexpr size_t k_min_runs{3};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Noise, so P3 samples have 1, 2 and 3 digits as in real images.
+static void fill_noise(arci::my_canvas& canvas) {
+  uint32_t state{12345};
+
+  for (arci::color& c : canvas.get_pixels()) {
+    state = state * 1664525u + 1013904223u;
+    c = arci::color{
+        static_cast<unsigned char>(state >> 8),
+        static_cast<unsigned char>(state >> 16),
+        static_cast<unsigned char>(state >> 24),
+    };
+  }
+}
+
+static size_t get_file_size() {
+  std::ifstream file{
+      std::string{k_file_name},
+      std::ios_base::binary | std::ios_base::ate};
+  return static_cast<size_t>(file.tellg());
+}
+
+template <typename Operation>
+static void run(
+    const std::string_view format,
+    const std::string_view operation_name,
+    Operation operation) {
+  const double seconds_per_run =
+      arci::get_seconds_per_run(k_min_seconds, k_min_runs, operation);
+
+  std::cout << std::left << std::setw(8) << format
+            << std::setw(8) << operation_name
+            << std::right << std::fixed << std::setprecision(1)
+            << std::setw(12) << get_file_size() / 1e6
+            << std::setw(12) << seconds_per_run * 1e3
+            << std::setw(12) << get_file_size() / seconds_per_run / 1e6
+            << std::setw(14) << k_width * k_height / seconds_per_run / 1e6
+            << "\n";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Saves and loads a 4K image in both formats. The file stays in the page
+// cache, so the numbers are for the codec rather than for the disk.
+int main(int, char** argv) {
+  FLAGS_logtostderr = true;
+  google::InitGoogleLogging(argv[0]);
+
+  std::cout << std::left << std::setw(8) << "format"
+            << std::setw(8) << "op"
+            << std::right << std::setw(12) << "MB"
+            << std::setw(12) << "ms/op"
+            << std::setw(12) << "MB/s"
+            << std::setw(14) << "Mpixels/s" << "\n";
+
+  for (const std::string format : {"P3", "P6"}) {
+    arci::my_canvas canvas{k_width, k_height, format};
+    fill_noise(canvas);
+
+    arci::my_canvas loaded{};
+
+    run(format, "save", [&]() { canvas.save_ppm_image(k_file_name); });
+    run(format, "load", [&]() { loaded.load_ppm_image(k_file_name); });
+
+    CHECK(loaded.get_pixels() == canvas.get_pixels())
+        << format << " image differs after loading";
+  }
+
+  std::remove(k_file_name.data());
+
+  return EXIT_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
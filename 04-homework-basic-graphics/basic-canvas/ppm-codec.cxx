@@ -0,0 +1,561 @@
+#include "ppm-codec.hxx"
+#include "simd-level.hxx"
+
+//
+#include <glog/logging.h>
+
+//
+#include <string_view>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ARCI_MAPPED_FILES
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// The P3 scanner classifies 16 bytes at once with SSE2, see
+// simd-level.hxx on how SIMD code is built.
+#ifdef ARCI_X86_SIMD
+#include <immintrin.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Whole file for reading. It is mapped into memory where the system
+// supports it, and read into a buffer elsewhere.
+class input_file final {
+ public:
+  explicit input_file(const std::string_view name);
+  ~input_file();
+  input_file(const input_file& other) = delete;
+  input_file& operator=(const input_file& other) = delete;
+
+  const unsigned char* get_data() const noexcept;
+  size_t get_size() const noexcept;
+
+ private:
+#ifdef ARCI_MAPPED_FILES
+  void* m_mapping{MAP_FAILED};
+#else
+  std::vector<unsigned char> m_buffer{};
+#endif
+  const unsigned char* m_data{};
+  size_t m_size{};
+};
+
+#ifdef ARCI_MAPPED_FILES
+
+input_file::input_file(const std::string_view name) {
+  const std::string path{name};
+  const int descriptor = ::open(path.c_str(), O_RDONLY);
+  CHECK(descriptor != -1) << "Error on opening '" << name << "' for reading";
+
+  struct stat status {};
+  CHECK(::fstat(descriptor, &status) == 0)
+      << "Error on getting the size of '" << name << "'";
+  m_size = static_cast<size_t>(status.st_size);
+  CHECK(m_size) << "File '" << name << "' is empty";
+
+  m_mapping = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+  ::close(descriptor);
+  CHECK(m_mapping != MAP_FAILED) << "Error on mapping '" << name << "'";
+
+  // Pages are read one after another, so the system may read ahead.
+  ::madvise(m_mapping, m_size, MADV_SEQUENTIAL);
+  m_data = static_cast<const unsigned char*>(m_mapping);
+}
+
+input_file::~input_file() {
+  ::munmap(m_mapping, m_size);
+}
+
+#else
+
+input_file::input_file(const std::string_view name) {
+  std::ifstream file{};
+
+  file.exceptions(std::ios_base::failbit);
+  file.open(std::string{name}, std::ios_base::binary | std::ios_base::ate);
+
+  CHECK(file.is_open()) << "Error on opening '" << name << "' for reading";
+
+  m_buffer.resize(static_cast<size_t>(file.tellg()));
+  CHECK(!m_buffer.empty()) << "File '" << name << "' is empty";
+
+  file.seekg(0);
+  file.read(
+      reinterpret_cast<char*>(m_buffer.data()),
+      static_cast<std::streamsize>(m_buffer.size()));
+
+  m_data = m_buffer.data();
+  m_size = m_buffer.size();
+}
+
+input_file::~input_file() = default;
+
+#endif // ARCI_MAPPED_FILES
+
+const unsigned char* input_file::get_data() const noexcept {
+  return m_data;
+}
+
+size_t input_file::get_size() const noexcept {
+  return m_size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static bool is_digit(const unsigned char symbol) {
+  return symbol >= '0' && symbol <= '9';
+}
+
+// Same symbols as `isspace()` in the "C" locale.
+static bool is_space(const unsigned char symbol) {
+  return symbol == ' ' || (symbol >= '\t' && symbol <= '\r');
+}
+
+// Reads header values one by one. Comments run from '#' to the end of
+// the line and may stand between any of them.
+class header_reader final {
+ public:
+  explicit header_reader(const input_file& file)
+    : m_data{file.get_data()},
+      m_size{file.get_size()} {}
+
+  std::string_view get_token() {
+    skip_spaces_and_comments();
+
+    const size_t first = m_position;
+    while (m_position < m_size && !is_space(m_data[m_position])
+           && m_data[m_position] != '#') {
+      ++m_position;
+    }
+
+    return std::string_view{
+        reinterpret_cast<const char*>(m_data + first),
+        m_position - first};
+  }
+
+  size_t get_number() {
+    const std::string_view token = get_token();
+    CHECK(!token.empty() && token.size() < 10)
+        << "Invalid number '" << token << "' in ppm header";
+
+    size_t result{};
+    for (const char symbol : token) {
+      CHECK(is_digit(static_cast<unsigned char>(symbol)))
+          << "Invalid number '" << token << "' in ppm header";
+      result = result * 10 + static_cast<size_t>(symbol - '0');
+    }
+
+    return result;
+  }
+
+  // Exactly one whitespace symbol ends the header.
+  size_t get_data_offset() {
+    CHECK(m_position < m_size && is_space(m_data[m_position]))
+        << "After max color value should be a whitespace symbol";
+    return m_position + 1;
+  }
+
+  const std::string& get_comments() const noexcept {
+    return m_comments;
+  }
+
+ private:
+  void skip_spaces_and_comments() {
+    while (m_position < m_size) {
+      if (is_space(m_data[m_position])) {
+        ++m_position;
+      } else if (m_data[m_position] == '#') {
+        const size_t first = m_position + 1;
+        while (m_position < m_size && m_data[m_position] != '\n'
+               && m_data[m_position] != '\r') {
+          ++m_position;
+        }
+        m_comments.append(
+            reinterpret_cast<const char*>(m_data + first),
+            m_position - first);
+        m_comments += "\n";
+      } else {
+        break;
+      }
+    }
+  }
+
+  const unsigned char* m_data{};
+  size_t m_size{};
+  size_t m_position{};
+  std::string m_comments{};
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Decodes decimal samples of P3 pixels. Samples are separated by
+// whitespace, comments may stand between them too.
+class p3_scanner final {
+ public:
+  p3_scanner(
+      unsigned char* samples,
+      const size_t samples_number,
+      const uint32_t max_value)
+    : m_samples{samples},
+      m_samples_number{samples_number},
+      m_max_value{max_value} {}
+
+  // Scans the bytes of the whole image data, a sample may end at the
+  // end of the file.
+  void scan(const unsigned char* first, const unsigned char* last) {
+#ifdef ARCI_X86_SIMD
+    if (is_simd_level_supported(simd_level::sse2)) {
+      first = scan_blocks_sse2(first, last);
+    }
+#endif
+
+    for (; first != last && !is_done(); ++first) {
+      scan_symbol(*first);
+    }
+    end_sample();
+
+    CHECK(is_done()) << "Image has " << m_samples_number << " samples, "
+                     << "but only " << m_samples_written << " are found";
+  }
+
+ private:
+  bool is_done() const noexcept {
+    return m_samples_written == m_samples_number;
+  }
+
+  // Samples past the last pixel are ignored.
+  void write_sample(const uint32_t value) {
+    CHECK(value <= m_max_value)
+        << "Sample " << m_samples_written << " is more than max color value "
+        << m_max_value;
+
+    if (!is_done()) {
+      m_samples[m_samples_written++] = static_cast<unsigned char>(value);
+    }
+  }
+
+  void end_sample() {
+    if (!m_digits) {
+      return;
+    }
+
+    CHECK(m_digits < 10)
+        << "Sample " << m_samples_written << " is more than max color value "
+        << m_max_value;
+    write_sample(m_value);
+
+    m_value = 0;
+    m_digits = 0;
+  }
+
+  void add_digits(
+      const unsigned char* symbols,
+      const size_t first,
+      const size_t last) {
+    for (size_t i = first; i < last; ++i) {
+      m_value = m_value * 10 + (symbols[i] - '0');
+    }
+    m_digits += last - first;
+  }
+
+  void scan_symbol(const unsigned char symbol) {
+    if (m_is_in_comment) {
+      m_is_in_comment = symbol != '\n' && symbol != '\r';
+    } else if (is_digit(symbol)) {
+      add_digits(&symbol, 0, 1);
+    } else {
+      end_sample();
+      m_is_in_comment = symbol == '#';
+      CHECK(m_is_in_comment || is_space(symbol))
+          << "Unexpected symbol with code " << static_cast<int>(symbol)
+          << " after sample " << m_samples_written;
+    }
+  }
+
+#ifdef ARCI_X86_SIMD
+  // Samples of blocks with digits and whitespace only are found by bit
+  // scans of their masks, so symbols aren't tested one by one. Blocks
+  // with comments or anything else go through `scan_symbol()`.
+  __attribute__((target("sse2"))) const unsigned char* scan_blocks_sse2(
+      const unsigned char* first,
+      const unsigned char* last) {
+    constexpr size_t k_block_size{16};
+    constexpr uint32_t k_block_mask{0xffff};
+
+    const __m128i before_zero = _mm_set1_epi8('0' - 1);
+    const __m128i after_nine = _mm_set1_epi8('9' + 1);
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i new_line = _mm_set1_epi8('\n');
+    const __m128i carriage_return = _mm_set1_epi8('\r');
+    const __m128i tab = _mm_set1_epi8('\t');
+
+    // Symbols of a block, and 2 more for short samples near its end.
+    alignas(16) unsigned char bytes[k_block_size + 2]{};
+
+    for (; last - first >= static_cast<ptrdiff_t>(k_block_size) && !is_done();
+         first += k_block_size) {
+      const __m128i block =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+
+      // Bytes above 127 are negative and never taken for digits.
+      const uint32_t digits = static_cast<uint32_t>(_mm_movemask_epi8(
+          _mm_and_si128(
+              _mm_cmpgt_epi8(block, before_zero),
+              _mm_cmplt_epi8(block, after_nine))));
+      const uint32_t spaces = static_cast<uint32_t>(_mm_movemask_epi8(
+          _mm_or_si128(
+              _mm_or_si128(
+                  _mm_cmpeq_epi8(block, space),
+                  _mm_cmpeq_epi8(block, new_line)),
+              _mm_or_si128(
+                  _mm_cmpeq_epi8(block, carriage_return),
+                  _mm_cmpeq_epi8(block, tab)))));
+
+      // Whatever follows the last sample is left unscanned.
+      if (m_is_in_comment || (digits | spaces) != k_block_mask) {
+        for (size_t i = 0; i < k_block_size; ++i) {
+          scan_symbol(first[i]);
+          if (is_done()) {
+            return first + i + 1;
+          }
+        }
+        continue;
+      }
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), block);
+
+      size_t i{};
+
+      // A sample of the previous block may go on.
+      if (m_digits) {
+        i = __builtin_ctz(~digits);
+        add_digits(bytes, 0, i);
+        if (i == k_block_size) {
+          continue;
+        }
+        end_sample();
+        if (is_done()) {
+          return first + i;
+        }
+      }
+
+      // First digits of the samples starting in this block.
+      uint32_t starts = digits & ~(digits << 1) & (k_block_mask << i);
+
+      while (starts) {
+        const size_t start = __builtin_ctz(starts);
+        // Bits past the block are set in the inverted mask, so a run
+        // stops at the block end.
+        const size_t run = __builtin_ctz(~(digits >> start));
+        starts &= starts - 1;
+
+        if (run <= 3 && start + run < k_block_size) {
+          // Run lengths are random, so all 3 values are computed and
+          // one of them is picked without branches.
+          const uint32_t d0 = bytes[start] - '0';
+          const uint32_t d1 = bytes[start + 1] - '0';
+          const uint32_t d2 = bytes[start + 2] - '0';
+          write_sample(
+              run == 1   ? d0
+              : run == 2 ? d0 * 10 + d1
+                         : d0 * 100 + d1 * 10 + d2);
+        } else {
+          // Leading zeros, or a sample going on in the next block.
+          add_digits(bytes, start, start + run);
+          if (start + run == k_block_size) {
+            break;
+          }
+          end_sample();
+        }
+
+        if (is_done()) {
+          return first + start + run;
+        }
+      }
+    }
+
+    return first;
+  }
+#endif // ARCI_X86_SIMD
+
+  unsigned char* m_samples{};
+  size_t m_samples_number{};
+  size_t m_samples_written{};
+  uint32_t m_max_value{};
+
+  // The sample being read.
+  uint32_t m_value{};
+  size_t m_digits{};
+
+  bool m_is_in_comment{false};
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+ppm_header load_ppm(const std::string_view name, std::vector<color>& pixels) {
+  const input_file file{name};
+  header_reader reader{file};
+  ppm_header header{};
+
+  header.format = reader.get_token();
+  CHECK("P3" == header.format || "P6" == header.format)
+      << "Function 'load_ppm' supports only 'P3' and 'P6' formats";
+
+  LOG(INFO) << "Format read from '" << name << "' is: " << header.format;
+
+  header.width = reader.get_number();
+  header.height = reader.get_number();
+  const size_t max_color_value = reader.get_number();
+  const size_t data_offset = reader.get_data_offset();
+
+  if (!reader.get_comments().empty()) {
+    LOG(INFO) << reader.get_comments();
+  }
+
+  LOG(INFO) << "Width: " << header.width;
+  LOG(INFO) << "Height: " << header.height;
+  LOG(INFO) << "Max color value is: " << max_color_value;
+
+  CHECK(max_color_value > 0 && max_color_value <= 255)
+      << "Only 8 bit samples are supported";
+
+  const unsigned char* data = file.get_data() + data_offset;
+  const size_t data_size = file.get_size() - data_offset;
+
+  // The size in the header is checked against the file before anything
+  // is allocated for it. P6 needs a byte per sample, P3 at least a digit
+  // per sample and a separator between every two of them.
+  constexpr size_t k_max_samples{
+      std::numeric_limits<size_t>::max() / 2 / sizeof(color)};
+  CHECK(header.width == 0 || header.height <= k_max_samples / header.width)
+      << "Image '" << name << "' is too big: " << header.width << "x"
+      << header.height;
+
+  const size_t samples_size = sizeof(color) * header.width * header.height;
+  const size_t min_data_size = header.format == "P3"
+      ? (samples_size == 0 ? 0 : 2 * samples_size - 1)
+      : samples_size;
+  CHECK(data_size >= min_data_size)
+      << "Image '" << name << "' has " << data_size << " bytes of pixels "
+      << "while " << header.width << "x" << header.height
+      << " needs at least " << min_data_size;
+
+  pixels.resize(header.width * header.height);
+  unsigned char* samples = reinterpret_cast<unsigned char*>(pixels.data());
+
+  if (header.format == "P3") {
+    p3_scanner scanner{
+        samples,
+        samples_size,
+        static_cast<uint32_t>(max_color_value)};
+    scanner.scan(data, data + data_size);
+  } else {
+    std::memcpy(samples, data, samples_size);
+  }
+
+  return header;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Decimal text of a sample with the symbol after it, at most 4 bytes,
+// so it is copied at once.
+struct sample_text {
+  std::array<char, 4> symbols{};
+  size_t size{};
+};
+
+static std::array<sample_text, 256> get_sample_texts(const char separator) {
+  std::array<sample_text, 256> result{};
+
+  for (size_t value = 0; value < result.size(); ++value) {
+    const std::string text = std::to_string(value) + separator;
+    std::memcpy(result[value].symbols.data(), text.data(), text.size());
+    result[value].size = text.size();
+  }
+
+  return result;
+}
+
+void save_ppm(
+    const std::string_view name,
+    const ppm_header& header,
+    const color* pixels) {
+  CHECK("P3" == header.format || "P6" == header.format)
+      << "Function 'save_ppm' supports only 'P3' and 'P6' formats";
+
+  const std::string head = header.format + "\n"
+      + std::to_string(header.width) + " " + std::to_string(header.height)
+      + "\n255\n";
+  const size_t pixels_number = header.width * header.height;
+  const size_t pixels_size = sizeof(color) * pixels_number;
+
+  // "255 255 255\n" is the longest P3 pixel.
+  constexpr size_t k_max_p3_pixel_size{12};
+  const size_t max_size = head.size()
+      + (header.format == "P3" ? pixels_number * k_max_p3_pixel_size
+                               : pixels_size);
+
+  // Left uninitialized, every byte written to the file is set first.
+  const std::unique_ptr<char[]> buffer{new char[max_size]};
+  std::memcpy(buffer.get(), head.data(), head.size());
+  char* output = buffer.get() + head.size();
+
+  if (header.format == "P3") {
+    static const std::array<sample_text, 256> k_texts{get_sample_texts(' ')};
+    static const std::array<sample_text, 256> k_last_texts{
+        get_sample_texts('\n')};
+
+    // Texts are copied with their padding, which the next one overwrites.
+    // The padding of the last one stays within its longest size.
+    auto write_text = [&output](const sample_text& text) {
+      std::memcpy(output, text.symbols.data(), text.symbols.size());
+      output += text.size;
+    };
+
+    for (size_t i = 0; i < pixels_number; ++i) {
+      write_text(k_texts[pixels[i].r]);
+      write_text(k_texts[pixels[i].g]);
+      write_text(k_last_texts[pixels[i].b]);
+    }
+  } else {
+    std::memcpy(output, pixels, pixels_size);
+    output += pixels_size;
+  }
+
+  std::ofstream file{};
+
+  file.exceptions(std::ios_base::failbit);
+  file.open(std::string{name}, std::ios_base::binary | std::ios_base::trunc);
+
+  CHECK(file.is_open())
+      << "Error on opening '" << name << "' for writing";
+
+  file.write(
+      buffer.get(),
+      static_cast<std::streamsize>(output - buffer.get()));
+  file.close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "my-basic-canvas.hxx"
+
+//
+#include <string_view>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci {
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct ppm_header {
+  // P3 or P6.
+  std::string format{"P6"};
+  size_t width{};
+  size_t height{};
+};
+
+// Reads a P3 or P6 image with 8 bit samples into `pixels`, resized to
+// its size. The file is mapped into memory, P6 pixels are copied from
+// the mapping straight into `pixels`.
+ppm_header load_ppm(const std::string_view name, std::vector<color>& pixels);
+
+// Writes `header.width * header.height` pixels. The whole file is
+// formatted in memory first and written at once.
+void save_ppm(
+    const std::string_view name,
+    const ppm_header& header,
+    const color* pixels);
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,119 @@
+#include "my-basic-canvas.hxx"
+
+//
+#include <glog/logging.h>
+
+//
+#include <string_view>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+constexpr std::string_view k_file_name{"ppm-test.ppm"};
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void write_file(const std::string& text) {
+  std::ofstream file{};
+
+  file.exceptions(std::ios_base::failbit);
+  file.open(std::string{k_file_name}, std::ios_base::binary);
+  file.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+// Loads `text` as an image of 4 pixels, 2 by 2.
+static void check_p3(
+    const std::string_view name,
+    const std::string& text,
+    const std::vector<arci::color>& expected) {
+  write_file(text);
+
+  arci::my_canvas canvas{};
+  canvas.load_ppm_image(k_file_name);
+
+  CHECK_EQ(canvas.get_width(), 2u) << name;
+  CHECK_EQ(canvas.get_height(), 2u) << name;
+  CHECK(canvas.get_pixels() == expected) << name;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int, char** argv) {
+  FLAGS_logtostderr = true;
+  google::InitGoogleLogging(argv[0]);
+
+  const std::vector<arci::color> pixels{
+      {255, 0, 7},
+      {10, 200, 99},
+      {0, 0, 0},
+      {1, 22, 255},
+  };
+
+  check_p3(
+      "plain",
+      "P3\n2 2\n255\n255 0 7\n10 200 99\n0 0 0\n1 22 255\n",
+      pixels);
+  check_p3(
+      "no new line at the end",
+      "P3\n2 2\n255\n255 0 7 10 200 99 0 0 0 1 22 255",
+      pixels);
+  check_p3(
+      "comments",
+      "P3 # magic\n# size\n2 2\n#max\n255\n255 0 7 # first\n"
+      "10 200 99\n# middle 1 2 3\n0 0 0\n1 22 255\n",
+      pixels);
+  check_p3(
+      "carriage returns and tabs",
+      "P3\r\n2\t2\r\n255\r\n255\t0\t7\r\n10 200 99\r\n0\v0\f0\r\n1 22 255",
+      pixels);
+  // Samples cross the 16 byte blocks of the SIMD scanner.
+  check_p3(
+      "long spaces",
+      "P3\n2 2\n255\n255" + std::string(13, ' ') + "0 7\n10 200 "
+          + std::string(40, '\n') + "99 0 0 000000000 1 22 255\n",
+      pixels);
+  check_p3(
+      "next image",
+      "P3\n2 2\n255\n255 0 7 10 200 99 0 0 0 1 22 255\nP3\n1 1\n255\n0 0 0\n",
+      pixels);
+
+  // Both formats give the same pixels back, RGBA ones with opaque alpha.
+  for (const std::string format : {"P3", "P6"}) {
+    arci::my_canvas canvas{37, 23, format};
+    for (size_t i = 0; i < canvas.get_pixels().size(); ++i) {
+      canvas.get_pixels()[i] = arci::color{
+          static_cast<unsigned char>(i),
+          static_cast<unsigned char>(i * 7),
+          static_cast<unsigned char>(i * 13),
+      };
+    }
+    canvas.save_ppm_image(k_file_name);
+
+    arci::my_canvas loaded{};
+    loaded.load_ppm_image(k_file_name);
+    CHECK_EQ(loaded.get_width(), 37u) << format;
+    CHECK_EQ(loaded.get_height(), 23u) << format;
+    CHECK(loaded.get_pixels() == canvas.get_pixels()) << format;
+
+    arci::rgba_canvas rgba{};
+    rgba.load_ppm_image(k_file_name);
+    for (size_t i = 0; i < rgba.get_pixels().size(); ++i) {
+      const arci::color& c = canvas.get_pixels()[i];
+      const arci::rgba_color expected{c.r, c.g, c.b, 255};
+      CHECK(rgba.get_pixels()[i] == expected) << format;
+    }
+
+    rgba.save_ppm_image(k_file_name);
+    loaded.load_ppm_image(k_file_name);
+    CHECK(loaded.get_pixels() == canvas.get_pixels()) << format;
+  }
+
+  std::remove(k_file_name.data());
+
+  return EXIT_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,44 @@
+#include "simd-level.hxx"
+
+//
+#include <string_view>
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci {
+
+///////////////////////////////////////////////////////////////////////////////
+
+simd_level get_supported_simd_level() {
+#ifdef ARCI_X86_SIMD
+  if (__builtin_cpu_supports("avx2")) {
+    return simd_level::avx2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return simd_level::sse2;
+  }
+#endif
+  return simd_level::scalar;
+}
+
+bool is_simd_level_supported(const simd_level level) {
+  return level <= get_supported_simd_level();
+}
+
+std::string_view get_simd_level_name(const simd_level level) {
+  switch (level) {
+    case simd_level::scalar:
+      return "scalar";
+    case simd_level::sse2:
+      return "sse2";
+    case simd_level::avx2:
+      return "avx2";
+  }
+  return "unknown";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci
+
+///////////////////////////////////////////////////////////////////////////////
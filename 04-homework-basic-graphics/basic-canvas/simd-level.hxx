@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string_view>
+
+// SIMD kernels are built for x86 with GCC or Clang only. They are
+// compiled with target attributes, so the rest of the program doesn't
+// need any -m flags, and picked at runtime by `simd_level`. Helpers of
+// the kernels take vectors by reference, so they have no vector ABI of
+// their own and inline into the kernels.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define ARCI_X86_SIMD
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci {
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum class simd_level {
+  scalar,
+  // 128 bit vectors.
+  sse2,
+  // 256 bit vectors.
+  avx2,
+};
+
+// The widest level the CPU running the program supports.
+simd_level get_supported_simd_level();
+bool is_simd_level_supported(const simd_level level);
+std::string_view get_simd_level_name(const simd_level level);
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci
+
+///////////////////////////////////////////////////////////////////////////////
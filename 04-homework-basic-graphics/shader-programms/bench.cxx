@@ -0,0 +1,190 @@
+#include "bench-helper.hxx"
+#include "bench-scenes.hxx"
+#include "shader-programm.hxx"
+#include "shaders.hxx"
+
+//
+#include <glog/logging.h>
+
+//
+#include <string_view>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+using arci::bench_scene;
+
+constexpr size_t k_width{800};
+constexpr size_t k_height{600};
+
+// Frames are rendered until both limits are reached.
+constexpr double k_min_seconds{0.5};
+constexpr size_t k_min_frames{3};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// A star of 6 triangles sharing their inner vertices, the way the demo
+// draws it.
+static bench_scene get_star_scene(const std::string_view name) {
+  constexpr float k_center_x{k_width / 2.f};
+  constexpr float k_center_y{k_height / 2.f};
+  constexpr float k_size{200.f};
+
+  auto get_vertex = [](const float x, const float y, const float r,
+                       const float g, const float b) {
+    return arci::vertex{
+        k_center_x + x * k_size,
+        k_center_y + y * k_size,
+        r,
+        g,
+        b,
+    };
+  };
+
+  return bench_scene{
+      name,
+      {
+          get_vertex(0.f, -1.5f, 0.f, 0.f, 255.f),
+          get_vertex(-0.5f, -0.5f, 0.f, 255.f, 0.f),
+          get_vertex(0.5f, -0.5f, 0.f, 255.f, 0.f),
+          get_vertex(-1.5f, 0.f, 255.f, 0.f, 0.f),
+          get_vertex(-0.5f, 0.5f, 255.f, 255.f, 50.f),
+          get_vertex(0.5f, 0.5f, 255.f, 255.f, 50.f),
+          get_vertex(1.5f, 0.f, 255.f, 0.f, 0.f),
+          get_vertex(0.f, 1.5f, 0.f, 0.f, 255.f),
+      },
+      {3, 1, 4, 0, 2, 1, 1, 5, 4, 1, 2, 5, 2, 6, 5, 4, 5, 7},
+  };
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// The way the demo runs a shader: both stages once per vertex with
+// virtual calls, then colors are interpolated by the span kernels.
+static void render_per_vertex(
+    arci::triangle_interpolated_render& render,
+    const arci::ishader_programm& shader,
+    const bench_scene& s,
+    std::vector<arci::vertex>& shaded_vertices) {
+  shaded_vertices.resize(s.vertices.size());
+
+  for (size_t i = 0; i < s.vertices.size(); ++i) {
+    arci::vertex v = shader.get_vertex_transformed(s.vertices[i]);
+    const arci::color c = shader.get_color_transformed(v);
+    v.r = static_cast<float>(c.r);
+    v.g = static_cast<float>(c.g);
+    v.b = static_cast<float>(c.b);
+    shaded_vertices[i] = v;
+  }
+
+  render.render(shaded_vertices, s.indices);
+}
+
+// Mpixels/s are counted over the area the scene covers, not the whole
+// canvas.
+template <typename Render>
+static void run(
+    const bench_scene& s,
+    const std::string_view shader_name,
+    const std::string_view pipeline_name,
+    Render render) {
+  const double seconds_per_frame =
+      arci::get_seconds_per_run(k_min_seconds, k_min_frames, render);
+  const double mpixels = arci::get_covered_pixels(s, k_width, k_height) / 1e6;
+
+  std::cout << std::left << std::setw(12) << s.name
+            << std::setw(16) << shader_name
+            << std::setw(12) << pipeline_name
+            << std::right << std::fixed << std::setprecision(3)
+            << std::setw(12) << seconds_per_frame * 1e3
+            << std::setw(14) << std::setprecision(1)
+            << mpixels / seconds_per_frame << "\n";
+}
+
+template <typename Shader>
+static void run_shader(
+    arci::my_canvas& canvas,
+    arci::triangle_interpolated_render& render,
+    const std::string_view shader_name,
+    const Shader& shader,
+    const bench_scene& s) {
+  const arci::ishader_programm& virtual_shader = shader;
+
+  // Both fragment pipelines have to give the same pixels.
+  canvas.fill_all_with_color({0, 0, 0});
+  render.render(virtual_shader, s.vertices, s.indices);
+  const std::vector<arci::color> virtual_pixels = canvas.get_pixels();
+
+  canvas.fill_all_with_color({0, 0, 0});
+  render.render(shader, s.vertices, s.indices);
+  CHECK(canvas.get_pixels() == virtual_pixels)
+      << "Templated pipeline differs from the virtual one for "
+      << shader_name << " in scene " << s.name;
+
+  std::vector<arci::vertex> shaded_vertices{};
+
+  run(s, shader_name, "per vertex", [&]() {
+    render_per_vertex(render, virtual_shader, s, shaded_vertices);
+  });
+  run(s, shader_name, "virtual", [&]() {
+    render.render(virtual_shader, s.vertices, s.indices);
+  });
+  run(s, shader_name, "template", [&]() {
+    render.render(shader, s.vertices, s.indices);
+  });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Compares the fragment stage run through `arci::ishader_programm` with
+// the one instantiated for the shader type. The demo way of running
+// shaders per vertex is measured for reference.
+int main(int, char** argv) {
+  FLAGS_logtostderr = true;
+  google::InitGoogleLogging(argv[0]);
+
+  arci::my_canvas canvas{k_width, k_height, "P6"};
+  arci::triangle_interpolated_render render{canvas};
+
+  const std::vector<bench_scene> scenes{
+      arci::get_grid_scene("fullscreen", k_width, k_height, 1, 1),
+      arci::get_grid_scene("grid-8px", k_width, k_height, 100, 75),
+      get_star_scene("star"),
+  };
+
+  const simple_shader simple{};
+  breath_shader breath{};
+  breath.set_uniform(arci::uniform{k_width / 2.f, k_height / 2.f});
+
+  std::cout << std::left << std::setw(12) << "scene"
+            << std::setw(16) << "shader"
+            << std::setw(12) << "pipeline"
+            << std::right << std::setw(12) << "ms/frame"
+            << std::setw(14) << "Mpixels/s" << "\n";
+
+  for (const bench_scene& s : scenes) {
+    run_shader(canvas, render, "simple_shader", simple, s);
+    run_shader(canvas, render, "breath_shader", breath, s);
+  }
+
+  // Shared vertices go through the vertex stage once per frame.
+  std::cout << "\n";
+  for (const bench_scene& s : scenes) {
+    render.render(simple, s.vertices, s.indices);
+
+    const arci::triangle_interpolated_render::vertex_cache_stats& stats =
+        render.get_vertex_cache_stats();
+    std::cout << std::left << std::setw(12) << s.name
+              << std::right << std::setw(8) << stats.indices << " indices"
+              << std::setw(8) << stats.transformed_vertices
+              << " vertices transformed" << std::setw(8)
+              << std::fixed << std::setprecision(1)
+              << stats.get_hit_rate() * 100.0 << "% hits\n";
+  }
+
+  return EXIT_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
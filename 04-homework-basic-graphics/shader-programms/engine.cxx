@@ -11,9 +11,14 @@
 #include <string_view>
 #include <algorithm>
 #include <array>
+#include <condition_variable>
+#include <cstring>
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <thread>
+#include <utility>
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -79,6 +84,11 @@ class engine_using_sdl final : public iengine {
   engine_using_sdl& operator=(const engine_using_sdl&) = delete;
   engine_using_sdl& operator=(engine_using_sdl&&) = delete;
 
+  void set_double_buffering(const bool is_enabled) override {
+    CHECK(!m_renderer) << "Double buffering is chosen before `init()`";
+    m_is_double_buffered = is_enabled;
+  }
+
   void init() override {
     // SDL initialization.
     CHECK_EQ(SDL_Init(SDL_INIT_VIDEO), 0)
@@ -105,6 +115,15 @@ class engine_using_sdl final : public iengine {
     m_canvas.set_resolution({k_width, k_height});
     m_canvas.fill_all_with_color({0, 0, 0});
 
+    m_render = std::make_unique<triangle_interpolated_render>(m_canvas);
+    m_render->set_threads_number(
+        std::max<size_t>(std::thread::hardware_concurrency(), 1));
+
+    if (m_is_double_buffered) {
+      m_shown_canvas = m_canvas;
+      m_raster_thread = std::thread{&engine_using_sdl::rasterize_frames, this};
+    }
+
     CHECK_EQ(
         SDL_SetWindowPosition(
             m_window.get(),
@@ -125,25 +144,18 @@ class engine_using_sdl final : public iengine {
         << "`SDL_CreateRenderer()` failed with the following error: "
         << SDL_GetError();
 
-    m_surface = std::unique_ptr<SDL_Surface, void (*)(SDL_Surface*)>(
-        SDL_CreateSurfaceFrom(
-            m_canvas.get_pixels().data(),
-            m_canvas.get_width(),
-            m_canvas.get_height(),
-            m_canvas.get_width() * sizeof(color),
-            SDL_PIXELFORMAT_RGB24),
-        SDL_DestroySurface);
-
-    CHECK(m_surface)
-        << "`SDL_CreateSurfaceFrom()` failed with the following error: "
-        << SDL_GetError();
-
+    // The only texture, every frame is streamed into it.
     m_texture = std::unique_ptr<SDL_Texture, void (*)(SDL_Texture*)>(
-        SDL_CreateTextureFromSurface(m_renderer.get(), m_surface.get()),
+        SDL_CreateTexture(
+            m_renderer.get(),
+            SDL_PIXELFORMAT_RGB24,
+            SDL_TEXTUREACCESS_STREAMING,
+            k_width,
+            k_height),
         SDL_DestroyTexture);
 
     CHECK(m_texture)
-        << "`SDL_CreateTextureFromSurface()` failed with the following error: "
+        << "`SDL_CreateTexture()` failed with the following error: "
         << SDL_GetError();
   }
 
@@ -197,19 +209,53 @@ class engine_using_sdl final : public iengine {
   void render(
       const std::vector<vertex>& vertices,
       const std::vector<uint32_t>& indices) override {
-    m_canvas.fill_all_with_color({0, 0, 0});
+    if (!m_is_double_buffered) {
+      m_canvas.fill_all_with_color({0, 0, 0});
+      m_render->render(vertices, indices);
 
-    triangle_interpolated_render render{m_canvas};
+      update_texture(m_canvas);
+      update_screen();
+      return;
+    }
 
-    render.render(vertices, indices);
+    // The frame rasterized during the previous call is shown while this
+    // one is rasterized, so the screen is 1 frame behind. The render
+    // stays bound to `m_canvas`, only the pixels of the canvases are
+    // swapped.
+    wait_for_rasterized_frame();
+    std::swap(m_canvas, m_shown_canvas);
+
+    // Callers are free to change their vertices right after this call.
+    m_vertices = vertices;
+    m_indices = indices;
+    {
+      std::lock_guard<std::mutex> lock{m_raster_mutex};
+      m_is_frame_pending = true;
+    }
+    m_raster_start.notify_one();
 
-    update_texture();
+    update_texture(m_shown_canvas);
     update_screen();
   }
 
   ///////////////////////////////////////////////////////////////////////////////
 
   void uninit() override {
+    if (m_raster_thread.joinable()) {
+      wait_for_rasterized_frame();
+      {
+        std::lock_guard<std::mutex> lock{m_raster_mutex};
+        m_is_stopping = true;
+      }
+      m_raster_start.notify_one();
+      m_raster_thread.join();
+    }
+
+    m_render.reset();
+
+    m_texture.reset();
+    m_renderer.reset();
+    m_window.reset();
     SDL_Quit();
   }
 
@@ -238,21 +284,31 @@ class engine_using_sdl final : public iengine {
 
   ///////////////////////////////////////////////////////////////////////////////
 
-  void update_texture() {
-    SDL_Surface* new_surface = SDL_CreateSurfaceFrom(
-        m_canvas.get_pixels().data(),
-        m_canvas.get_width(),
-        m_canvas.get_height(),
-        m_canvas.get_width() * sizeof(color),
-        SDL_PIXELFORMAT_RGB24);
-    CHECK_NOTNULL(new_surface);
-    m_surface.reset(new_surface);
-
-    SDL_Texture* new_texture = SDL_CreateTextureFromSurface(
-        m_renderer.get(),
-        m_surface.get());
-    CHECK_NOTNULL(new_texture);
-    m_texture.reset(new_texture);
+  void update_texture(my_canvas& canvas) {
+    void* texture_pixels{nullptr};
+    int pitch{};
+
+    CHECK_EQ(
+        SDL_LockTexture(m_texture.get(), nullptr, &texture_pixels, &pitch),
+        0)
+        << "`SDL_LockTexture` failed with the following error: "
+        << SDL_GetError();
+
+    const size_t row_size = canvas.get_width() * sizeof(color);
+    const unsigned char* source =
+        reinterpret_cast<const unsigned char*>(canvas.get_pixels().data());
+    unsigned char* destination = static_cast<unsigned char*>(texture_pixels);
+
+    // Rows of the texture may be padded.
+    if (static_cast<size_t>(pitch) == row_size) {
+      std::memcpy(destination, source, row_size * canvas.get_height());
+    } else {
+      for (size_t y = 0; y < canvas.get_height(); ++y) {
+        std::memcpy(destination + y * pitch, source + y * row_size, row_size);
+      }
+    }
+
+    SDL_UnlockTexture(m_texture.get());
   }
 
   ///////////////////////////////////////////////////////////////////////////////
@@ -277,7 +333,56 @@ class engine_using_sdl final : public iengine {
 
   ///////////////////////////////////////////////////////////////////////////////
 
+  // Body of the raster thread, which lives from `init()` to `uninit()`
+  // with double buffering. The render's own thread pool runs the tiles,
+  // this thread takes part as its calling thread.
+  void rasterize_frames() {
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock{m_raster_mutex};
+        m_raster_start.wait(
+            lock,
+            [this]() { return m_is_frame_pending || m_is_stopping; });
+
+        if (m_is_stopping) {
+          return;
+        }
+      }
+
+      m_canvas.fill_all_with_color({0, 0, 0});
+      m_render->render(m_vertices, m_indices);
+
+      {
+        std::lock_guard<std::mutex> lock{m_raster_mutex};
+        m_is_frame_pending = false;
+      }
+      m_raster_finish.notify_one();
+    }
+  }
+
+  void wait_for_rasterized_frame() {
+    std::unique_lock<std::mutex> lock{m_raster_mutex};
+    m_raster_finish.wait(lock, [this]() { return !m_is_frame_pending; });
+  }
+
+  ///////////////////////////////////////////////////////////////////////////////
+
   my_canvas m_canvas{};
+  // Keeps its threads and buffers between frames.
+  std::unique_ptr<triangle_interpolated_render> m_render{};
+  bool m_is_double_buffered{false};
+
+  // With double buffering: the frame being uploaded, copies of the
+  // vertices being rasterized and the raster thread with its state.
+  my_canvas m_shown_canvas{};
+  std::vector<vertex> m_vertices{};
+  std::vector<uint32_t> m_indices{};
+  std::thread m_raster_thread{};
+  std::mutex m_raster_mutex{};
+  std::condition_variable m_raster_start{};
+  std::condition_variable m_raster_finish{};
+  bool m_is_frame_pending{false};
+  bool m_is_stopping{false};
 
   std::unique_ptr<SDL_Renderer, void (*)(SDL_Renderer*)>
       m_renderer{nullptr, nullptr};
@@ -287,9 +392,6 @@ class engine_using_sdl final : public iengine {
 
   std::unique_ptr<SDL_Texture, void (*)(SDL_Texture*)>
       m_texture{nullptr, nullptr};
-
-  std::unique_ptr<SDL_Surface, void (*)(SDL_Surface*)>
-      m_surface{nullptr, nullptr};
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -65,6 +65,10 @@ struct event {
 class iengine {
  public:
   virtual ~iengine() = default;
+  // With double buffering a frame is rasterized on another thread while
+  // the previous one is shown, 1 frame later than it's rendered. Off by
+  // default, chosen before `init()`.
+  virtual void set_double_buffering(const bool is_enabled) = 0;
   virtual void init() = 0;
   virtual bool process_input(event& event) = 0;
   virtual void render(
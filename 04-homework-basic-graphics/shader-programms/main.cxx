@@ -1,121 +1,18 @@
 #include "engine.hxx"
 #include "shader-programm.hxx"
+#include "shaders.hxx"
 //
 #include <glog/logging.h>
 
 //
+#include <string_view>
 #include <algorithm>
 #include <array>
-#include <cmath>
 #include <memory>
 #include <vector>
 
 ///////////////////////////////////////////////////////////////////////////////
 
-class simple_shader : public arci::ishader_programm {
- public:
-  arci::vertex get_vertex_transformed(
-      const arci::vertex& v_in) const override {
-    arci::vertex result = v_in;
-    // Do nothing.
-    return result;
-  }
-
-  arci::color get_color_transformed(
-      [[maybe_unused]] const arci::vertex& v_in) const override {
-    const unsigned char r = static_cast<unsigned char>(v_in.r);
-    const unsigned char g = static_cast<unsigned char>(v_in.g);
-    const unsigned char b = static_cast<unsigned char>(v_in.b);
-    return arci::color{r, g, b};
-  }
-};
-
-///////////////////////////////////////////////////////////////////////////////
-
-class breath_shader : public arci::ishader_programm {
- public:
-  arci::vertex get_vertex_transformed(
-      const arci::vertex& v_in) const override {
-    arci::vertex result{v_in};
-
-    constexpr float circle_radius{200.f};
-    const float circle_center_x{m_uniform.u0};
-    const float circle_center_y{m_uniform.u1};
-
-    float delta_x{1.f};
-    float delta_y{1.f};
-    float new_x{}, new_y{};
-    static bool is_reducing{false};
-
-    // Distance from vertex to center of circle.
-    // Figure is in a circle, remember it.
-    const float distance_vertex_circle_center =
-        std::sqrt(
-            std::pow(v_in.x - circle_center_x, 2.f)
-            + std::pow(v_in.y - circle_center_y, 2.f));
-
-    // It's time to reduce figure.
-    if (distance_vertex_circle_center > circle_radius) {
-      is_reducing = true;
-    }
-
-    // We've almost reached the center of a circle. It's time
-    // to make figure increase.
-    if (distance_vertex_circle_center < 5.f) {
-      is_reducing = false;
-    }
-
-    if (v_in.x < circle_center_x) {
-      delta_x *= -1.f;
-    }
-    if (v_in.y < circle_center_y) {
-      delta_y *= -1.f;
-    }
-
-    // Reverse order for steps.
-    if (is_reducing) {
-      delta_x *= -1.f;
-      delta_y *= -1.f;
-    }
-
-    // Vertex is changing only for OY axis.
-    if (std::abs(v_in.x - circle_center_x) == 0) {
-      new_x = v_in.x;
-      new_y = v_in.y + delta_y;
-    }
-    // Vertex is changing only for OX axis.
-    else if (std::abs(v_in.y - circle_center_y) == 0) {
-      new_x = v_in.x + delta_x;
-      new_y = v_in.y;
-    } else {
-      // First we increment x value for vertex.
-      // Then we can easily calculate y value
-      // basing on the school equation for lines.
-      // (x - x1) / (x2 - x1) = (y - y1) / (y2 - y1)
-      new_x = v_in.x + delta_x;
-      new_y = (new_x - circle_center_x)
-              * (v_in.y - circle_center_y) / (v_in.x - circle_center_x)
-          + circle_center_y;
-    }
-
-    result.x = new_x;
-    result.y = new_y;
-
-    return result;
-  }
-
-  arci::color get_color_transformed(
-      [[maybe_unused]] const arci::vertex& v_in) const override {
-    return arci::color{
-        static_cast<unsigned char>(v_in.r),
-        static_cast<unsigned char>(v_in.g),
-        static_cast<unsigned char>(v_in.b),
-    };
-  }
-};
-
-///////////////////////////////////////////////////////////////////////////////
-
 constexpr float triangle_height{100.f};
 constexpr float triangle_base{100.f};
 constexpr float center_circle_x{399.f};
@@ -241,7 +138,8 @@ static void process_vertices_with_shader(
 
 ///////////////////////////////////////////////////////////////////////////////
 
-int main(int, char** argv) {
+// Usage: shaders-bin [--double-buffered]
+int main(int argc, char** argv) {
   FLAGS_logtostderr = true;
   google::InitGoogleLogging(argv[0]);
 
@@ -250,6 +148,8 @@ int main(int, char** argv) {
       arci::engine_create(),
       arci::engine_destroy};
 
+  engine->set_double_buffering(
+      argc > 1 && std::string_view{argv[1]} == "--double-buffered");
   engine->init();
 
   std::array<std::unique_ptr<arci::ishader_programm>, 3> shaders{
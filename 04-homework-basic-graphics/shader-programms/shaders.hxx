@@ -0,0 +1,114 @@
+#pragma once
+
+#include "shader-programm.hxx"
+
+//
+#include <cmath>
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Shaders are final, so the templated pipeline calls them directly and
+// inlines them.
+class simple_shader final : public arci::ishader_programm {
+ public:
+  arci::vertex get_vertex_transformed(
+      const arci::vertex& v_in) const override {
+    arci::vertex result = v_in;
+    // Do nothing.
+    return result;
+  }
+
+  arci::color get_color_transformed(
+      [[maybe_unused]] const arci::vertex& v_in) const override {
+    const unsigned char r = static_cast<unsigned char>(v_in.r);
+    const unsigned char g = static_cast<unsigned char>(v_in.g);
+    const unsigned char b = static_cast<unsigned char>(v_in.b);
+    return arci::color{r, g, b};
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class breath_shader final : public arci::ishader_programm {
+ public:
+  arci::vertex get_vertex_transformed(
+      const arci::vertex& v_in) const override {
+    arci::vertex result{v_in};
+
+    constexpr float circle_radius{200.f};
+    const float circle_center_x{m_uniform.u0};
+    const float circle_center_y{m_uniform.u1};
+
+    float delta_x{1.f};
+    float delta_y{1.f};
+    float new_x{}, new_y{};
+    static bool is_reducing{false};
+
+    // Distance from vertex to center of circle.
+    // Figure is in a circle, remember it.
+    const float distance_vertex_circle_center =
+        std::sqrt(
+            std::pow(v_in.x - circle_center_x, 2.f)
+            + std::pow(v_in.y - circle_center_y, 2.f));
+
+    // It's time to reduce figure.
+    if (distance_vertex_circle_center > circle_radius) {
+      is_reducing = true;
+    }
+
+    // We've almost reached the center of a circle. It's time
+    // to make figure increase.
+    if (distance_vertex_circle_center < 5.f) {
+      is_reducing = false;
+    }
+
+    if (v_in.x < circle_center_x) {
+      delta_x *= -1.f;
+    }
+    if (v_in.y < circle_center_y) {
+      delta_y *= -1.f;
+    }
+
+    // Reverse order for steps.
+    if (is_reducing) {
+      delta_x *= -1.f;
+      delta_y *= -1.f;
+    }
+
+    // Vertex is changing only for OY axis.
+    if (std::abs(v_in.x - circle_center_x) == 0) {
+      new_x = v_in.x;
+      new_y = v_in.y + delta_y;
+    }
+    // Vertex is changing only for OX axis.
+    else if (std::abs(v_in.y - circle_center_y) == 0) {
+      new_x = v_in.x + delta_x;
+      new_y = v_in.y;
+    } else {
+      // First we increment x value for vertex.
+      // Then we can easily calculate y value
+      // basing on the school equation for lines.
+      // (x - x1) / (x2 - x1) = (y - y1) / (y2 - y1)
+      new_x = v_in.x + delta_x;
+      new_y = (new_x - circle_center_x)
+              * (v_in.y - circle_center_y) / (v_in.x - circle_center_x)
+          + circle_center_y;
+    }
+
+    result.x = new_x;
+    result.y = new_y;
+
+    return result;
+  }
+
+  arci::color get_color_transformed(
+      [[maybe_unused]] const arci::vertex& v_in) const override {
+    return arci::color{
+        static_cast<unsigned char>(v_in.r),
+        static_cast<unsigned char>(v_in.g),
+        static_cast<unsigned char>(v_in.b),
+    };
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////
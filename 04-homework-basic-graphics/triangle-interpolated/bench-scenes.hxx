@@ -0,0 +1,116 @@
+#pragma once
+
+#include "triangle-interpolated-render.hxx"
+
+//
+#include <string_view>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Scenes shared by the benchmarks of the triangle render and of the
+// shader programms.
+
+namespace arci {
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct bench_scene {
+  std::string_view name{};
+  std::vector<vertex> vertices{};
+  std::vector<uint32_t> indices{};
+  // Triangles reach far beyond the canvas. The scanline rasterizer would
+  // walk every pixel of them, so it isn't measured.
+  bool is_huge{false};
+};
+
+// Colors change along both axes, so every pixel of a span differs.
+inline vertex get_bench_vertex(
+    const float x,
+    const float y,
+    const size_t width,
+    const size_t height) {
+  return vertex{
+      x,
+      y,
+      255.f * x / width,
+      255.f * y / height,
+      255.f - 255.f * x / width,
+  };
+}
+
+// Canvas of `width` x `height` covered by a grid of cells, 2 triangles
+// per cell. Vertices stay on the canvas, which the scanline rasterizer
+// needs.
+inline bench_scene get_grid_scene(
+    const std::string_view name,
+    const size_t width,
+    const size_t height,
+    const uint32_t columns,
+    const uint32_t rows) {
+  bench_scene result{name, {}, {}};
+
+  const float cell_width = static_cast<float>(width - 1) / columns;
+  const float cell_height = static_cast<float>(height - 1) / rows;
+
+  for (uint32_t j = 0; j <= rows; ++j) {
+    for (uint32_t i = 0; i <= columns; ++i) {
+      result.vertices.push_back(get_bench_vertex(
+          i * cell_width,
+          j * cell_height,
+          width,
+          height));
+    }
+  }
+
+  for (uint32_t j = 0; j < rows; ++j) {
+    for (uint32_t i = 0; i < columns; ++i) {
+      const uint32_t top_left = j * (columns + 1) + i;
+      const uint32_t bottom_left = top_left + columns + 1;
+      result.indices.insert(
+          result.indices.end(),
+          {
+              top_left,
+              top_left + 1,
+              bottom_left,
+              top_left + 1,
+              bottom_left + 1,
+              bottom_left,
+          });
+    }
+  }
+
+  return result;
+}
+
+// Sum of the triangle areas of a scene, overlaps counted as many times
+// as they are drawn. A huge scene covers the whole canvas.
+inline double get_covered_pixels(
+    const bench_scene& s,
+    const size_t width,
+    const size_t height) {
+  if (s.is_huge) {
+    return static_cast<double>(width * height);
+  }
+
+  double result{};
+
+  for (size_t i = 0; i < s.indices.size(); i += 3) {
+    const vertex& v0 = s.vertices.at(s.indices.at(i));
+    const vertex& v1 = s.vertices.at(s.indices.at(i + 1));
+    const vertex& v2 = s.vertices.at(s.indices.at(i + 2));
+    result += std::abs((v1.x - v0.x) * (v2.y - v0.y)
+                       - (v2.x - v0.x) * (v1.y - v0.y))
+        / 2.0;
+  }
+
+  return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci
+
+///////////////////////////////////////////////////////////////////////////////
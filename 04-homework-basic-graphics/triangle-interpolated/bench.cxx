@@ -0,0 +1,220 @@
+#include "bench-helper.hxx"
+#include "bench-scenes.hxx"
+#include "triangle-interpolated-render.hxx"
+
+//
+#include <glog/logging.h>
+
+//
+#include <string_view>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+using arci::bench_scene;
+
+constexpr size_t k_width{800};
+constexpr size_t k_height{600};
+
+// Frames are rendered until both limits are reached.
+constexpr double k_min_seconds{0.5};
+constexpr size_t k_min_frames{3};
+
+///////////////////////////////////////////////////////////////////////////////
+
+static arci::vertex get_vertex(const float x, const float y) {
+  return arci::get_bench_vertex(x, y, k_width, k_height);
+}
+
+static bench_scene get_grid_scene(
+    const std::string_view name,
+    const uint32_t columns,
+    const uint32_t rows) {
+  return arci::get_grid_scene(name, k_width, k_height, columns, rows);
+}
+
+// Big overlapping triangles fanned around the canvas center.
+static bench_scene get_fan_scene(const std::string_view name) {
+  constexpr uint32_t k_triangles{16};
+  constexpr float k_pi{3.14159265f};
+  constexpr float k_radius{290.f};
+
+  bench_scene result{name, {get_vertex(k_width / 2.f, k_height / 2.f)}, {}};
+
+  for (uint32_t i = 0; i < k_triangles; ++i) {
+    const float angle = 2.f * k_pi * i / k_triangles;
+    result.vertices.push_back(get_vertex(
+        k_width / 2.f + k_radius * std::cos(angle),
+        k_height / 2.f + k_radius * std::sin(angle)));
+  }
+
+  for (uint32_t i = 0; i < k_triangles; ++i) {
+    // Every triangle spans a quarter of the circle.
+    result.indices.insert(
+        result.indices.end(),
+        {0, 1 + i, 1 + (i + k_triangles / 4) % k_triangles});
+  }
+
+  return result;
+}
+
+// 2 triangles covering the canvas with their vertices a million pixels
+// away, so only clipping keeps them cheap.
+static bench_scene get_huge_scene(const std::string_view name) {
+  constexpr float k_far{1e6f};
+
+  return bench_scene{
+      name,
+      {
+          get_vertex(-k_far, -k_far),
+          get_vertex(k_far, -k_far),
+          get_vertex(-k_far, k_far),
+          get_vertex(k_far, k_far),
+      },
+      {0, 1, 2, 1, 3, 2},
+      true,
+  };
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static void run_scene(
+    arci::triangle_interpolated_render& render,
+    const std::string& rasterizer_name,
+    const bench_scene& s) {
+  const double seconds_per_frame = arci::get_seconds_per_run(
+      k_min_seconds,
+      k_min_frames,
+      [&]() { render.render(s.vertices, s.indices); });
+  const double mpixels = arci::get_covered_pixels(s, k_width, k_height) / 1e6;
+
+  std::cout << std::left << std::setw(16) << s.name
+            << std::setw(16) << rasterizer_name
+            << std::right << std::fixed << std::setprecision(3)
+            << std::setw(12) << seconds_per_frame * 1e3
+            << std::setw(14) << std::setprecision(1)
+            << mpixels / seconds_per_frame << "\n";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Usage: triangle-interpolated-bench [max threads number], every core by
+// default.
+int main(int argc, char** argv) {
+  FLAGS_logtostderr = true;
+  google::InitGoogleLogging(argv[0]);
+
+  arci::my_canvas canvas{k_width, k_height, "P6"};
+  arci::triangle_interpolated_render render{canvas};
+
+  const std::vector<bench_scene> scenes{
+      get_grid_scene("fullscreen", 1, 1),
+      get_grid_scene("grid-32px", 25, 19),
+      get_grid_scene("grid-8px", 100, 75),
+      get_grid_scene("grid-4px", 200, 150),
+      get_fan_scene("fan-16"),
+      get_huge_scene("huge"),
+  };
+
+  const std::vector<arci::simd_level> simd_levels =
+      arci::get_supported_simd_levels();
+
+  // The edge function rasterizer has to cover the whole canvas with
+  // a quad around it. Pixel centers are at integer coordinates, so the
+  // canvas spans from -0.5 to its size - 0.5.
+  const std::vector<arci::vertex> quad_vertices{
+      get_vertex(-0.5f, -0.5f),
+      get_vertex(k_width - 0.5f, -0.5f),
+      get_vertex(-0.5f, k_height - 0.5f),
+      get_vertex(k_width - 0.5f, k_height - 0.5f),
+  };
+
+  canvas.fill_all_with_color({0, 0, 0});
+  render.render(quad_vertices, {0, 1, 2, 1, 3, 2});
+
+  for (const arci::color& c : canvas.get_pixels()) {
+    CHECK(!(c == arci::color{0, 0, 0})) << "Canvas quad left a hole";
+  }
+
+  // Every SIMD level has to give the same pixels as the scalar code, and
+  // so do the tiles rasterized on several threads.
+  for (const bench_scene& s : scenes) {
+    arci::check_simd_levels_match_scalar(
+        canvas,
+        s.name,
+        [&](const arci::simd_level level) {
+          canvas.fill_all_with_color({0, 0, 0});
+          render.set_simd_level(level);
+          render.render(s.vertices, s.indices);
+        });
+
+    const arci::my_canvas::pixels scalar_pixels = canvas.get_pixels();
+
+    canvas.fill_all_with_color({0, 0, 0});
+    render.set_threads_number(4);
+    render.render(s.vertices, s.indices);
+    render.set_threads_number(1);
+
+    CHECK(canvas.get_pixels() == scalar_pixels)
+        << "Tiled pixels differ from scalar ones in scene " << s.name;
+  }
+
+  std::cout << std::left << std::setw(16) << "scene"
+            << std::setw(16) << "rasterizer"
+            << std::right << std::setw(12) << "ms/frame"
+            << std::setw(14) << "Mpixels/s" << "\n";
+
+  for (const bench_scene& s : scenes) {
+    if (!s.is_huge) {
+      render.set_rasterizer(
+          arci::triangle_interpolated_render::rasterizer::scanline);
+      run_scene(render, "scanline", s);
+    }
+
+    render.set_rasterizer(
+        arci::triangle_interpolated_render::rasterizer::edge_function);
+
+    for (const arci::simd_level level : simd_levels) {
+      render.set_simd_level(level);
+      run_scene(render, std::string{arci::get_simd_level_name(level)}, s);
+    }
+  }
+
+  // Scaling of the tiled rasterizer from 1 thread to every core.
+  const size_t cores_number = argc > 1
+      ? std::stoul(argv[1])
+      : std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  CHECK(cores_number) << "At least 1 thread is needed";
+
+  std::cout << "\n" << std::thread::hardware_concurrency() << " cores, "
+            << "up to " << cores_number << " threads, "
+            << arci::get_simd_level_name(arci::get_supported_simd_level())
+            << " kernels\n";
+
+  render.set_simd_level(arci::get_supported_simd_level());
+
+  // Powers of 2 below the limit, then the limit itself, so odd core
+  // counts are measured too.
+  std::vector<size_t> threads_numbers{};
+  for (size_t threads = 1; threads < cores_number; threads *= 2) {
+    threads_numbers.push_back(threads);
+  }
+  threads_numbers.push_back(cores_number);
+
+  for (const bench_scene& s : scenes) {
+    for (const size_t threads : threads_numbers) {
+      render.set_threads_number(threads);
+      run_scene(render, std::to_string(threads) + " threads", s);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
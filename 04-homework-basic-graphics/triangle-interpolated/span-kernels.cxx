@@ -0,0 +1,280 @@
+#include "span-kernels.hxx"
+
+//
+#include <glog/logging.h>
+
+//
+#include <algorithm>
+#include <cstring>
+
+// See simd-level.hxx on how the SIMD kernels are built.
+#ifdef ARCI_X86_SIMD
+#include <immintrin.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Edge values are exact integers. Colors are computed with the same
+// float operations and rounding adds 0.5 before truncation in every
+// kernel. This keeps them bit exact with the scalar one.
+static void shade_span_scalar(
+    const span_setup& setup,
+    const span_start& start,
+    color* pixels,
+    const int32_t first,
+    const int32_t count,
+    const bool is_inside) {
+  auto get_channel = [](const float value) {
+    return static_cast<unsigned char>(std::clamp(value, 0.f, 255.f) + 0.5f);
+  };
+
+  for (int32_t i = first; i < count; ++i) {
+    const int32_t w0 = start.w[0] + i * setup.step[0];
+    const int32_t w1 = start.w[1] + i * setup.step[1];
+    const int32_t w2 = start.w[2] + i * setup.step[2];
+
+    if (!is_inside && (w0 | w1 | w2) < 0) {
+      continue;
+    }
+
+    const float offset = static_cast<float>(i);
+    pixels[i].r = get_channel(start.rgb[0] + offset * setup.color_step[0]);
+    pixels[i].g = get_channel(start.rgb[1] + offset * setup.color_step[1]);
+    pixels[i].b = get_channel(start.rgb[2] + offset * setup.color_step[2]);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef ARCI_X86_SIMD
+
+// Writes 3 bytes of every covered lane of packed 0x00BBGGRR values.
+template <size_t lanes>
+static void store_covered_lanes(
+    const uint32_t (&packed)[lanes],
+    color* pixels,
+    int mask) {
+  while (mask) {
+    const int lane = __builtin_ctz(static_cast<unsigned>(mask));
+    std::memcpy(
+        reinterpret_cast<unsigned char*>(pixels + lane),
+        &packed[lane],
+        sizeof(color));
+    mask &= mask - 1;
+  }
+}
+
+__attribute__((target("sse2"))) static void pack_colors_sse2(
+    const __m128 (&rgb)[3],
+    uint32_t (&packed)[4]) {
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 max = _mm_set1_ps(255.f);
+  const __m128 half = _mm_set1_ps(0.5f);
+
+  __m128i channels[3];
+  for (size_t k = 0; k < 3; ++k) {
+    channels[k] = _mm_cvttps_epi32(
+        _mm_add_ps(_mm_min_ps(_mm_max_ps(rgb[k], zero), max), half));
+  }
+
+  _mm_storeu_si128(
+      reinterpret_cast<__m128i*>(packed),
+      _mm_or_si128(
+          _mm_or_si128(channels[0], _mm_slli_epi32(channels[1], 8)),
+          _mm_slli_epi32(channels[2], 16)));
+}
+
+__attribute__((target("sse2"))) static void shade_span_sse2(
+    const span_setup& setup,
+    const span_start& start,
+    color* pixels,
+    const int32_t first,
+    const int32_t count,
+    const bool is_inside) {
+  constexpr int32_t k_lanes{4};
+
+  const __m128 lane_offsets = _mm_setr_ps(0.f, 1.f, 2.f, 3.f);
+
+  // SSE2 has no 32 bit multiplication, so lane steps are made here.
+  __m128i w[3], chunk_step[3];
+  __m128 color_start[3], color_step[3];
+  for (size_t k = 0; k < 3; ++k) {
+    const int32_t step = setup.step[k];
+    w[k] = _mm_add_epi32(
+        _mm_set1_epi32(start.w[k] + first * step),
+        _mm_setr_epi32(0, step, 2 * step, 3 * step));
+    chunk_step[k] = _mm_set1_epi32(k_lanes * step);
+    color_start[k] = _mm_set1_ps(start.rgb[k]);
+    color_step[k] = _mm_set1_ps(setup.color_step[k]);
+  }
+
+  // The last lanes of a span may be past its end, they are computed but
+  // never stored.
+  for (int32_t i = first; i < count; i += k_lanes) {
+    int mask = count - i < k_lanes ? (1 << (count - i)) - 1 : 0xf;
+    if (!is_inside) {
+      // Sign bits of negative edge values.
+      const __m128i outside = _mm_or_si128(_mm_or_si128(w[0], w[1]), w[2]);
+      mask &= ~_mm_movemask_ps(_mm_castsi128_ps(outside));
+    }
+
+    for (size_t k = 0; k < 3; ++k) {
+      w[k] = _mm_add_epi32(w[k], chunk_step[k]);
+    }
+
+    if (!mask) {
+      continue;
+    }
+
+    const __m128 offset = _mm_add_ps(
+        _mm_set1_ps(static_cast<float>(i)),
+        lane_offsets);
+    const __m128 rgb[3]{
+        _mm_add_ps(color_start[0], _mm_mul_ps(offset, color_step[0])),
+        _mm_add_ps(color_start[1], _mm_mul_ps(offset, color_step[1])),
+        _mm_add_ps(color_start[2], _mm_mul_ps(offset, color_step[2])),
+    };
+
+    uint32_t packed[k_lanes];
+    pack_colors_sse2(rgb, packed);
+    store_covered_lanes(packed, pixels + i, mask);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+__attribute__((target("avx2"))) static void pack_colors_avx2(
+    const __m256 (&rgb)[3],
+    uint32_t (&packed)[8]) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 max = _mm256_set1_ps(255.f);
+  const __m256 half = _mm256_set1_ps(0.5f);
+
+  __m256i channels[3];
+  for (size_t k = 0; k < 3; ++k) {
+    channels[k] = _mm256_cvttps_epi32(_mm256_add_ps(
+        _mm256_min_ps(_mm256_max_ps(rgb[k], zero), max),
+        half));
+  }
+
+  _mm256_storeu_si256(
+      reinterpret_cast<__m256i*>(packed),
+      _mm256_or_si256(
+          _mm256_or_si256(channels[0], _mm256_slli_epi32(channels[1], 8)),
+          _mm256_slli_epi32(channels[2], 16)));
+}
+
+// Drops the 4th byte of every packed value and writes 8 pixels as
+// 24 contiguous bytes.
+__attribute__((target("avx2"))) static void store_all_lanes_avx2(
+    const uint32_t (&packed)[8],
+    color* pixels) {
+  const __m256i drop_fourth_bytes = _mm256_setr_epi8(
+      0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+      0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+  alignas(32) unsigned char bytes[32];
+  _mm256_store_si256(
+      reinterpret_cast<__m256i*>(bytes),
+      _mm256_shuffle_epi8(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(packed)),
+          drop_fourth_bytes));
+
+  unsigned char* destination = reinterpret_cast<unsigned char*>(pixels);
+  std::memcpy(destination, bytes, 12);
+  std::memcpy(destination + 12, bytes + 16, 12);
+}
+
+__attribute__((target("avx2"))) static void shade_span_avx2(
+    const span_setup& setup,
+    const span_start& start,
+    color* pixels,
+    const int32_t first,
+    const int32_t count,
+    const bool is_inside) {
+  constexpr int32_t k_lanes{8};
+
+  const __m256i lane_indices = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m256 lane_offsets =
+      _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f);
+
+  __m256i w[3], chunk_step[3];
+  __m256 color_start[3], color_step[3];
+  for (size_t k = 0; k < 3; ++k) {
+    const __m256i step = _mm256_set1_epi32(setup.step[k]);
+    w[k] = _mm256_add_epi32(
+        _mm256_set1_epi32(start.w[k] + first * setup.step[k]),
+        _mm256_mullo_epi32(lane_indices, step));
+    chunk_step[k] = _mm256_set1_epi32(k_lanes * setup.step[k]);
+    color_start[k] = _mm256_set1_ps(start.rgb[k]);
+    color_step[k] = _mm256_set1_ps(setup.color_step[k]);
+  }
+
+  // The last lanes of a span may be past its end, they are computed but
+  // never stored.
+  for (int32_t i = first; i < count; i += k_lanes) {
+    int mask = count - i < k_lanes ? (1 << (count - i)) - 1 : 0xff;
+    if (!is_inside) {
+      // Sign bits of negative edge values.
+      const __m256i outside =
+          _mm256_or_si256(_mm256_or_si256(w[0], w[1]), w[2]);
+      mask &= ~_mm256_movemask_ps(_mm256_castsi256_ps(outside));
+    }
+
+    for (size_t k = 0; k < 3; ++k) {
+      w[k] = _mm256_add_epi32(w[k], chunk_step[k]);
+    }
+
+    if (!mask) {
+      continue;
+    }
+
+    const __m256 offset = _mm256_add_ps(
+        _mm256_set1_ps(static_cast<float>(i)),
+        lane_offsets);
+    const __m256 rgb[3]{
+        _mm256_add_ps(color_start[0], _mm256_mul_ps(offset, color_step[0])),
+        _mm256_add_ps(color_start[1], _mm256_mul_ps(offset, color_step[1])),
+        _mm256_add_ps(color_start[2], _mm256_mul_ps(offset, color_step[2])),
+    };
+
+    uint32_t packed[k_lanes];
+    pack_colors_avx2(rgb, packed);
+
+    if (mask == 0xff) {
+      store_all_lanes_avx2(packed, pixels + i);
+    } else {
+      store_covered_lanes(packed, pixels + i, mask);
+    }
+  }
+}
+
+#endif // ARCI_X86_SIMD
+
+///////////////////////////////////////////////////////////////////////////////
+
+span_kernel get_span_kernel(const simd_level level) {
+  CHECK(is_simd_level_supported(level))
+      << "CPU doesn't support " << get_simd_level_name(level);
+
+  switch (level) {
+#ifdef ARCI_X86_SIMD
+    case simd_level::avx2:
+      return shade_span_avx2;
+    case simd_level::sse2:
+      return shade_span_sse2;
+#endif
+    default:
+      return shade_span_scalar;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "my-basic-canvas.hxx"
+#include "simd-level.hxx"
+
+//
+#include <array>
+#include <cstdint>
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// A triangle prepared for shading a row of pixels.
+struct span_setup {
+  // Increments of the integer edge functions for one pixel to the right.
+  // A pixel is covered when all 3 edge values are not negative.
+  std::array<int32_t, 3> step{};
+  // Increments of r, g and b for one pixel to the right.
+  std::array<float, 3> color_step{};
+};
+
+// Values of a triangle at the start of a pixel row.
+struct span_start {
+  std::array<int32_t, 3> w{};
+  std::array<float, 3> rgb{};
+};
+
+// Shades pixels from `first` up to `count` of a row which starts at
+// `pixels`. Pixels outside the triangle are left as they are, unless
+// `is_inside` tells that the whole span is covered.
+//
+// Pixel `i` gets its values as `start + i * step` whatever the span
+// bounds are, so the result doesn't depend on how a row is split into
+// spans, and all kernels produce exactly the same pixels.
+using span_kernel = void (*)(
+    const span_setup& setup,
+    const span_start& start,
+    color* pixels,
+    const int32_t first,
+    const int32_t count,
+    const bool is_inside);
+
+span_kernel get_span_kernel(const simd_level level);
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,110 @@
+#include "thread-pool.hxx"
+
+//
+#include <glog/logging.h>
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci {
+
+///////////////////////////////////////////////////////////////////////////////
+
+thread_pool::thread_pool(const size_t threads_number)
+  : m_threads_number{threads_number},
+    m_ranges{std::make_unique<task_range[]>(threads_number)} {
+  CHECK(threads_number) << "Thread pool needs at least 1 thread";
+
+  for (size_t i = 1; i < threads_number; ++i) {
+    m_threads.emplace_back(&thread_pool::work, this, i);
+  }
+}
+
+thread_pool::~thread_pool() {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_is_stopping = true;
+  }
+  m_start.notify_all();
+
+  for (std::thread& thread : m_threads) {
+    thread.join();
+  }
+}
+
+size_t thread_pool::get_threads_number() const noexcept {
+  return m_threads_number;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void thread_pool::run(
+    const size_t tasks_number,
+    const std::function<void(size_t)>& task) {
+  {
+    std::lock_guard<std::mutex> lock{m_mutex};
+
+    for (size_t i = 0; i < m_threads_number; ++i) {
+      m_ranges[i].next.store(
+          tasks_number * i / m_threads_number,
+          std::memory_order_relaxed);
+      m_ranges[i].end = tasks_number * (i + 1) / m_threads_number;
+    }
+
+    m_task = &task;
+    m_busy_threads = m_threads.size();
+    ++m_generation;
+  }
+  m_start.notify_all();
+
+  run_tasks(0);
+
+  std::unique_lock<std::mutex> lock{m_mutex};
+  m_finish.wait(lock, [this]() { return m_busy_threads == 0; });
+  m_task = nullptr;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void thread_pool::work(const size_t thread_index) {
+  size_t generation{};
+
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock{m_mutex};
+      m_start.wait(lock, [this, generation]() {
+        return m_is_stopping || m_generation != generation;
+      });
+
+      if (m_is_stopping) {
+        return;
+      }
+
+      generation = m_generation;
+    }
+
+    run_tasks(thread_index);
+
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (--m_busy_threads == 0) {
+      m_finish.notify_one();
+    }
+  }
+}
+
+void thread_pool::run_tasks(const size_t thread_index) {
+  // Own range first, then the others in turn.
+  for (size_t i = 0; i < m_threads_number; ++i) {
+    task_range& range = m_ranges[(thread_index + i) % m_threads_number];
+
+    for (size_t task = range.next.fetch_add(1); task < range.end;
+         task = range.next.fetch_add(1)) {
+      (*m_task)(task);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,66 @@
+#pragma once
+
+//
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci {
+
+///////////////////////////////////////////////////////////////////////////////
+
+class thread_pool final {
+ public:
+  // The calling thread is counted as one of `threads_number`.
+  explicit thread_pool(const size_t threads_number);
+  ~thread_pool();
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool(thread_pool&&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+  thread_pool& operator=(thread_pool&&) = delete;
+
+  size_t get_threads_number() const noexcept;
+
+  // Calls `task(i)` for every `i` from 0 up to `tasks_number` and returns
+  // when all calls are done. Every thread starts with its own contiguous
+  // range of tasks and steals from the other ranges when it runs out.
+  void run(
+      const size_t tasks_number,
+      const std::function<void(size_t)>& task);
+
+ private:
+  // Owner and thieves take tasks from the front of a range, so one
+  // atomic counter is enough.
+  struct alignas(64) task_range {
+    std::atomic<size_t> next{};
+    size_t end{};
+  };
+
+  void work(const size_t thread_index);
+  void run_tasks(const size_t thread_index);
+
+  size_t m_threads_number{};
+  std::unique_ptr<task_range[]> m_ranges{};
+  std::vector<std::thread> m_threads{};
+
+  std::mutex m_mutex{};
+  std::condition_variable m_start{};
+  std::condition_variable m_finish{};
+  const std::function<void(size_t)>* m_task{nullptr};
+  size_t m_generation{};
+  size_t m_busy_threads{};
+  bool m_is_stopping{false};
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci
+
+///////////////////////////////////////////////////////////////////////////////
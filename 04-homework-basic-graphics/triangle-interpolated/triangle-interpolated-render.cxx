@@ -6,6 +6,7 @@
 //
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <vector>
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -34,10 +35,129 @@ static vertex get_interpolated_vertex(
   };
 }
 
+static int64_t get_floor_division(const int64_t value, const int64_t divisor) {
+  return value / divisor - (value % divisor < 0 ? 1 : 0);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
-triangle_interpolated_render::triangle_interpolated_render(my_canvas& canvas)
-  : line_render(canvas) {}
+// Position and colors of a vertex while it's clipped. Doubles keep
+// intersections of huge triangles precise.
+using clip_vertex = std::array<double, 5>;
+
+// A triangle clipped by 4 planes has up to 7 vertices.
+constexpr size_t k_max_clipped_vertices{7};
+
+// Sutherland-Hodgman step: keeps the part of a convex polygon where
+// `sign * value[axis] <= bound` and returns the number of its vertices.
+static size_t get_clipped_polygon(
+    const std::array<clip_vertex, k_max_clipped_vertices>& polygon,
+    const size_t size,
+    const size_t axis,
+    const double sign,
+    const double bound,
+    std::array<clip_vertex, k_max_clipped_vertices>& result) {
+  size_t result_size{};
+
+  for (size_t i = 0; i < size; ++i) {
+    const clip_vertex& current = polygon[i];
+    const clip_vertex& next = polygon[(i + 1) % size];
+    const bool is_current_inside = sign * current[axis] <= bound;
+    const bool is_next_inside = sign * next[axis] <= bound;
+
+    if (is_current_inside) {
+      result[result_size++] = current;
+    }
+
+    if (is_current_inside == is_next_inside) {
+      continue;
+    }
+
+    // Always stepping from the inside vertex cuts an edge shared by 2
+    // triangles at exactly the same point for both of them.
+    const clip_vertex& inside = is_current_inside ? current : next;
+    const clip_vertex& outside = is_current_inside ? next : current;
+    const double tau =
+        (sign * bound - inside[axis]) / (outside[axis] - inside[axis]);
+
+    clip_vertex& intersection = result[result_size++];
+    for (size_t k = 0; k < intersection.size(); ++k) {
+      intersection[k] = inside[k] + (outside[k] - inside[k]) * tau;
+    }
+    intersection[axis] = sign * bound;
+  }
+
+  return result_size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct triangle_interpolated_render::triangle_setup {
+  // Edge opposite to a vertex gives the weight of that vertex. Values of
+  // the edges and colors are kept for the top left corner of `bounds`,
+  // together with their increments along X in `span` and along Y here.
+  span_setup span{};
+  span_start origin{};
+  std::array<int32_t, 3> step_y{};
+  std::array<float, 3> color_step_y{};
+  // Covered part of the canvas, never empty.
+  pixel_rect bounds{};
+  // Degenerate triangles have no interior. They are drawn as lines the
+  // way the scanline rasterizer does it, and these are their pixels with
+  // whole coordinates.
+  std::vector<vertex> line_pixels{};
+};
+///////////////////////////////////////////////////////////////////////////////
+
+triangle_interpolated_render::triangle_interpolated_render(
+    my_canvas& canvas,
+    const rasterizer type)
+  : line_render(canvas),
+    m_rasterizer{type} {}
+
+triangle_interpolated_render::~triangle_interpolated_render() = default;
+
+void triangle_interpolated_render::set_rasterizer(const rasterizer type) {
+  m_rasterizer = type;
+}
+
+void triangle_interpolated_render::set_simd_level(const simd_level level) {
+  m_span_kernel = get_span_kernel(level);
+}
+
+void triangle_interpolated_render::set_scissor(
+    const size_t x,
+    const size_t y,
+    const size_t width,
+    const size_t height) {
+  // Canvases are limited anyway, and clamping keeps the sums in range.
+  auto get_clamped = [](const size_t value) {
+    return static_cast<int32_t>(
+        std::min<size_t>(value, std::numeric_limits<int32_t>::max() / 2));
+  };
+
+  m_scissor = pixel_rect{
+      get_clamped(x),
+      get_clamped(y),
+      get_clamped(x) + get_clamped(width) - 1,
+      get_clamped(y) + get_clamped(height) - 1,
+  };
+}
+
+void triangle_interpolated_render::reset_scissor() {
+  m_scissor.reset();
+}
+
+void triangle_interpolated_render::set_threads_number(
+    const size_t threads_number) {
+  CHECK(threads_number) << "Render needs at least 1 thread";
+
+  if (threads_number == 1) {
+    m_thread_pool.reset();
+  } else {
+    m_thread_pool = std::make_unique<thread_pool>(threads_number);
+  }
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -48,28 +168,606 @@ void triangle_interpolated_render::render(
 
   const size_t num_indices = indices.size();
 
+  if (m_rasterizer == rasterizer::scanline) {
+    m_clip = get_clip_rect();
+
+    for (size_t i = 0; i < num_indices; i += 3) {
+      std::array<vertex, 3> triangle{
+          vertices.at(indices.at(i)),
+          vertices.at(indices.at(i + 1)),
+          vertices.at(indices.at(i + 2)),
+      };
+      render_scanline_triangle(triangle);
+    }
+    return;
+  }
+
+  transform_vertices(no_vertex_shader{}, vertices, indices);
+  render_transformed(indices, fragment_stage{});
+}
+
+const triangle_interpolated_render::vertex_cache_stats&
+triangle_interpolated_render::get_vertex_cache_stats() const noexcept {
+  return m_vertex_cache_stats;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+triangle_interpolated_render::transformed_vertex
+triangle_interpolated_render::get_snapped_vertex(const vertex& v) {
+  constexpr float k_subpixels{1 << k_subpixel_bits};
+  constexpr float k_guard_band_fixed{k_guard_band * k_subpixels};
+
+  const float fixed_x = v.x * k_subpixels;
+  const float fixed_y = v.y * k_subpixels;
+
+  // Also false for NaN.
+  if (!(std::abs(fixed_x) <= k_guard_band_fixed
+        && std::abs(fixed_y) <= k_guard_band_fixed)) {
+    return transformed_vertex{v, 0, 0, false};
+  }
+
+  return transformed_vertex{
+      v,
+      std::llround(fixed_x),
+      std::llround(fixed_y),
+      true,
+  };
+}
+
+void triangle_interpolated_render::render_transformed(
+    const std::vector<uint32_t>& indices,
+    const fragment_stage& fragments) {
+  CHECK(indices.size() % 3 == 0) << "Triangle consists of 3 vertices";
+  CHECK(m_rasterizer == rasterizer::edge_function)
+      << "Shaders run on the edge function rasterizer only";
+  CHECK(m_canvas.get_width() <= k_max_coordinate
+        && m_canvas.get_height() <= k_max_coordinate)
+      << "Edge function rasterizer supports canvases up to "
+      << k_max_coordinate << " pixels";
+
+  m_clip = get_clip_rect();
+
+  if (m_clip.min_x > m_clip.max_x || m_clip.min_y > m_clip.max_y) {
+    return;
+  }
+
+  const size_t num_indices = indices.size();
+
+  m_triangles.resize(num_indices / 3);
+  size_t num_triangles{};
+
+  // Indices were checked by the vertex stage.
   for (size_t i = 0; i < num_indices; i += 3) {
-    std::array<vertex, 3> triangle{
-        vertices.at(indices.at(i)),
-        vertices.at(indices.at(i + 1)),
-        vertices.at(indices.at(i + 2)),
+    const std::array<const transformed_vertex*, 3> triangle{
+        &m_transformed_vertices[indices[i]],
+        &m_transformed_vertices[indices[i + 1]],
+        &m_transformed_vertices[indices[i + 2]],
     };
 
-    const std::vector<vertex> rasterized_vertices =
-        get_rasterized_triangle(triangle);
+    if (triangle[0]->is_in_range && triangle[1]->is_in_range
+        && triangle[2]->is_in_range) {
+      add_triangle(triangle, num_triangles);
+    } else {
+      add_clipped_triangle(triangle, num_triangles);
+    }
+  }
+
+  m_triangles.resize(num_triangles);
+
+  if (m_thread_pool) {
+    rasterize_tiles(fragments);
+    return;
+  }
+
+  // Bounds of every triangle are within the clip rectangle already.
+  for (const triangle_setup& setup : m_triangles) {
+    rasterize_triangle(setup, m_clip, fragments);
+  }
+}
+
+triangle_interpolated_render::pixel_rect
+triangle_interpolated_render::get_clip_rect() const {
+  pixel_rect result{
+      0,
+      0,
+      static_cast<int32_t>(m_canvas.get_width()) - 1,
+      static_cast<int32_t>(m_canvas.get_height()) - 1,
+  };
+
+  if (m_scissor) {
+    result.min_x = std::max(result.min_x, m_scissor->min_x);
+    result.min_y = std::max(result.min_y, m_scissor->min_y);
+    result.max_x = std::min(result.max_x, m_scissor->max_x);
+    result.max_y = std::min(result.max_y, m_scissor->max_y);
+  }
 
-    for (const vertex& vertex : rasterized_vertices) {
+  return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void triangle_interpolated_render::add_triangle(
+    const std::array<const transformed_vertex*, 3>& triangle,
+    size_t& num_triangles) {
+  if (num_triangles == m_triangles.size()) {
+    m_triangles.emplace_back();
+  }
+
+  if (get_triangle_setup(triangle, m_triangles[num_triangles])) {
+    ++num_triangles;
+  }
+}
+
+void triangle_interpolated_render::add_clipped_triangle(
+    const std::array<const transformed_vertex*, 3>& triangle,
+    size_t& num_triangles) {
+  std::array<clip_vertex, k_max_clipped_vertices> polygon{};
+
+  for (size_t i = 0; i < 3; ++i) {
+    const vertex& v = triangle[i]->v;
+
+    if (!std::isfinite(v.x) || !std::isfinite(v.y)) {
+      return;
+    }
+
+    polygon[i] = clip_vertex{v.x, v.y, v.r, v.g, v.b};
+  }
+
+  // Triangles entirely on the outer side of a clip rectangle edge are
+  // skipped without clipping. Pixel centers are at integer coordinates.
+  auto is_outside = [&polygon](
+                        const size_t axis,
+                        const double sign,
+                        const double bound) {
+    return sign * polygon[0][axis] > bound
+        && sign * polygon[1][axis] > bound
+        && sign * polygon[2][axis] > bound;
+  };
+
+  if (is_outside(0, -1.0, -(m_clip.min_x - 0.5))
+      || is_outside(0, 1.0, m_clip.max_x + 0.5)
+      || is_outside(1, -1.0, -(m_clip.min_y - 0.5))
+      || is_outside(1, 1.0, m_clip.max_y + 0.5)) {
+    return;
+  }
+
+  // A pixel inside keeps the rounding of clipped vertices in range.
+  constexpr double k_bound{k_guard_band - 1};
+
+  std::array<clip_vertex, k_max_clipped_vertices> clipped{};
+  size_t size{3};
+  size = get_clipped_polygon(polygon, size, 0, -1.0, k_bound, clipped);
+  size = get_clipped_polygon(clipped, size, 0, 1.0, k_bound, polygon);
+  size = get_clipped_polygon(polygon, size, 1, -1.0, k_bound, clipped);
+  size = get_clipped_polygon(clipped, size, 1, 1.0, k_bound, polygon);
+
+  std::array<transformed_vertex, k_max_clipped_vertices> vertices{};
+
+  for (size_t i = 0; i < size; ++i) {
+    vertices[i] = get_snapped_vertex(vertex{
+        static_cast<float>(polygon[i][0]),
+        static_cast<float>(polygon[i][1]),
+        static_cast<float>(polygon[i][2]),
+        static_cast<float>(polygon[i][3]),
+        static_cast<float>(polygon[i][4]),
+    });
+  }
+
+  // The polygon is convex, so it's a fan of triangles. Clipping leaves
+  // collinear vertices on the guard band, and their slivers with no area
+  // would be drawn as long lines, so they are skipped. So is a huge
+  // degenerate triangle as a whole.
+  for (size_t i = 2; i < size; ++i) {
+    const transformed_vertex& v0 = vertices[0];
+    const transformed_vertex& v1 = vertices[i - 1];
+    const transformed_vertex& v2 = vertices[i];
+
+    if ((v1.fixed_x - v0.fixed_x) * (v2.fixed_y - v0.fixed_y)
+        == (v1.fixed_y - v0.fixed_y) * (v2.fixed_x - v0.fixed_x)) {
+      continue;
+    }
+
+    add_triangle({&v0, &v1, &v2}, num_triangles);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool triangle_interpolated_render::get_triangle_setup(
+    const std::array<const transformed_vertex*, 3>& triangle,
+    triangle_setup& setup) {
+  constexpr int64_t k_subpixels{1 << k_subpixel_bits};
+
+  std::array<int64_t, 3> x{}, y{};
+
+  for (size_t i = 0; i < 3; ++i) {
+    if (!triangle[i]->is_in_range) {
+      return false;
+    }
+
+    x[i] = triangle[i]->fixed_x;
+    y[i] = triangle[i]->fixed_y;
+  }
+
+  // Twice the area in squared subpixels.
+  int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+
+  setup.line_pixels.clear();
+
+  if (area == 0) {
+    setup.bounds = pixel_rect{
+        m_clip.max_x + 1,
+        m_clip.max_y + 1,
+        m_clip.min_x - 1,
+        m_clip.min_y - 1,
+    };
+
+    std::array<vertex, 3> line{
+        triangle[0]->v,
+        triangle[1]->v,
+        triangle[2]->v,
+    };
+
+    for (const vertex& v : get_rasterized_triangle(line)) {
       const point p{
-          static_cast<int32_t>(std::lround(vertex.x)),
-          static_cast<int32_t>(std::lround(vertex.y)),
+          static_cast<int32_t>(std::lround(v.x)),
+          static_cast<int32_t>(std::lround(v.y)),
       };
-      const color c{
-          static_cast<unsigned char>(std::lround(vertex.r)),
-          static_cast<unsigned char>(std::lround(vertex.g)),
-          static_cast<unsigned char>(std::lround(vertex.b)),
-      };
-      set_pixel(p, c);
+
+      if (p.x < m_clip.min_x || p.y < m_clip.min_y || p.x > m_clip.max_x
+          || p.y > m_clip.max_y) {
+        continue;
+      }
+
+      setup.line_pixels.push_back(vertex{
+          static_cast<float>(p.x),
+          static_cast<float>(p.y),
+          v.r,
+          v.g,
+          v.b,
+      });
+
+      setup.bounds.min_x = std::min(setup.bounds.min_x, p.x);
+      setup.bounds.min_y = std::min(setup.bounds.min_y, p.y);
+      setup.bounds.max_x = std::max(setup.bounds.max_x, p.x);
+      setup.bounds.max_y = std::max(setup.bounds.max_y, p.y);
     }
+
+    return !setup.line_pixels.empty();
+  }
+
+  std::array<const vertex*, 3> vertices{
+      &triangle[0]->v,
+      &triangle[1]->v,
+      &triangle[2]->v,
+  };
+
+  // Y axis goes down, so positive area means clockwise on the screen
+  // and interior on the positive side of every edge.
+  if (area < 0) {
+    std::swap(x[1], x[2]);
+    std::swap(y[1], y[2]);
+    std::swap(vertices[1], vertices[2]);
+    area = -area;
+  }
+
+  // Pixel centers are at integer coordinates, the same as for vertices
+  // rounded by the scanline rasterizer.
+  setup.bounds = pixel_rect{
+      std::max(
+          m_clip.min_x,
+          static_cast<int32_t>(get_floor_division(
+              *std::min_element(x.begin(), x.end()) + k_subpixels - 1,
+              k_subpixels))),
+      std::max(
+          m_clip.min_y,
+          static_cast<int32_t>(get_floor_division(
+              *std::min_element(y.begin(), y.end()) + k_subpixels - 1,
+              k_subpixels))),
+      std::min(
+          m_clip.max_x,
+          static_cast<int32_t>(get_floor_division(
+              *std::max_element(x.begin(), x.end()),
+              k_subpixels))),
+      std::min(
+          m_clip.max_y,
+          static_cast<int32_t>(get_floor_division(
+              *std::max_element(y.begin(), y.end()),
+              k_subpixels))),
+  };
+
+  if (setup.bounds.min_x > setup.bounds.max_x
+      || setup.bounds.min_y > setup.bounds.max_y) {
+    return false;
+  }
+
+  const int64_t origin_x = setup.bounds.min_x;
+  const int64_t origin_y = setup.bounds.min_y;
+
+  for (size_t k = 0; k < 3; ++k) {
+    const size_t from = (k + 1) % 3;
+    const size_t to = (k + 2) % 3;
+
+    // Edge function a * x + b * y + c in subpixels, positive inside.
+    const int64_t a = y[from] - y[to];
+    const int64_t b = x[to] - x[from];
+    const int64_t c = -(a * x[from] + b * y[from]);
+
+    // Top-left rule: points right on an edge belong to the triangle only
+    // if the edge is a left one (interior to the right of it) or a top
+    // one (horizontal with interior below).
+    const bool is_top_left = a > 0 || (a == 0 && b > 0);
+    const int64_t bias = is_top_left ? 0 : -1;
+
+    // At pixel centers x and y are whole pixels, and for integer `p`
+    // k_subpixels * p + c + bias >= 0 is the same as
+    // p + floor((c + bias) / k_subpixels) >= 0. So edge values are
+    // exact integers in pixel steps.
+    const int64_t pixel_c = get_floor_division(c + bias, k_subpixels);
+
+    setup.span.step[k] = static_cast<int32_t>(a);
+    setup.step_y[k] = static_cast<int32_t>(b);
+    setup.origin.w[k] =
+        static_cast<int32_t>(a * origin_x + b * origin_y + pixel_c);
+  }
+
+  // Colors are interpolated with barycentric weights, which are the
+  // exact edge values divided by the area.
+  const double inverse_area = 1.0 / static_cast<double>(area);
+
+  for (size_t channel = 0; channel < 3; ++channel) {
+    double value{}, step_x{}, step_y{};
+
+    for (size_t k = 0; k < 3; ++k) {
+      const size_t from = (k + 1) % 3;
+      const size_t to = (k + 2) % 3;
+      const double a = static_cast<double>(y[from] - y[to]);
+      const double b = static_cast<double>(x[to] - x[from]);
+      const double c = -(a * x[from] + b * y[from]);
+
+      const vertex& v = *vertices[k];
+      const double attribute = channel == 0 ? v.r : channel == 1 ? v.g : v.b;
+      const double weight_x = a * k_subpixels * inverse_area;
+      const double weight_y = b * k_subpixels * inverse_area;
+      const double weight = (a * k_subpixels * origin_x
+                             + b * k_subpixels * origin_y + c)
+          * inverse_area;
+
+      value += weight * attribute;
+      step_x += weight_x * attribute;
+      step_y += weight_y * attribute;
+    }
+
+    setup.origin.rgb[channel] = static_cast<float>(value);
+    setup.span.color_step[channel] = static_cast<float>(step_x);
+    setup.color_step_y[channel] = static_cast<float>(step_y);
+  }
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void triangle_interpolated_render::rasterize_triangle(
+    const triangle_setup& setup,
+    const pixel_rect& clip,
+    const fragment_stage& fragments) {
+  // Pixels are classified in square blocks, so whole blocks outside or
+  // inside the triangle are decided by their corners alone.
+  constexpr int32_t k_block_size{8};
+
+  const int32_t min_x = std::max(setup.bounds.min_x, clip.min_x);
+  const int32_t min_y = std::max(setup.bounds.min_y, clip.min_y);
+  const int32_t max_x = std::min(setup.bounds.max_x, clip.max_x);
+  const int32_t max_y = std::min(setup.bounds.max_y, clip.max_y);
+
+  if (min_x > max_x || min_y > max_y) {
+    return;
+  }
+
+  const size_t width = m_canvas.get_width();
+  color* const pixels = m_canvas.get_pixels().data();
+
+  if (!setup.line_pixels.empty()) {
+    for (const vertex& v : setup.line_pixels) {
+      const int32_t x = static_cast<int32_t>(v.x);
+      const int32_t y = static_cast<int32_t>(v.y);
+
+      if (x < min_x || x > max_x || y < min_y || y > max_y) {
+        continue;
+      }
+
+      color* const pixel = pixels + static_cast<size_t>(y) * width + x;
+
+      if (fragments.shade_span) {
+        // A span of 1 pixel with no steps.
+        fragments.shade_span(
+            fragments.shader,
+            span_setup{},
+            span_start{{}, {v.r, v.g, v.b}},
+            pixel,
+            x,
+            y,
+            0,
+            1,
+            true);
+      } else {
+        *pixel = color{
+            static_cast<unsigned char>(std::lround(v.r)),
+            static_cast<unsigned char>(std::lround(v.g)),
+            static_cast<unsigned char>(std::lround(v.b)),
+        };
+      }
+    }
+    return;
+  }
+
+  // Values of a pixel are always stepped from the corner of the triangle
+  // bounds, so they don't depend on the clip rectangle. Edge values are
+  // exact and linear, so over a block they reach their extremes in its
+  // corners.
+  const int32_t origin_x = setup.bounds.min_x;
+  const int32_t origin_y = setup.bounds.min_y;
+
+  auto get_row_start = [&setup, origin_y](const int32_t y) {
+    const int32_t rows = y - origin_y;
+    const float offset = static_cast<float>(rows);
+    span_start result{};
+    for (size_t k = 0; k < 3; ++k) {
+      result.w[k] = setup.origin.w[k] + rows * setup.step_y[k];
+      result.rgb[k] = setup.origin.rgb[k] + offset * setup.color_step_y[k];
+    }
+    return result;
+  };
+
+  for (int32_t block_y = min_y; block_y <= max_y; block_y += k_block_size) {
+    const int32_t last_y = std::min(block_y + k_block_size - 1, max_y);
+
+    const int32_t rows = last_y - block_y;
+
+    // Blocks touching a convex triangle are contiguous within a row of
+    // blocks, so each pixel row is shaded as one span from the first
+    // touching block to the last one.
+    int32_t span_first_x{max_x + 1};
+    int32_t span_last_x{min_x - 1};
+    bool is_span_inside{true};
+
+    const span_start top = get_row_start(block_y);
+
+    for (int32_t block_x = min_x; block_x <= max_x;
+         block_x += k_block_size) {
+      const int32_t last_x = std::min(block_x + k_block_size - 1, max_x);
+
+      bool is_outside{false};
+      bool is_inside{true};
+
+      for (size_t k = 0; k < 3; ++k) {
+        const int32_t top_left =
+            top.w[k] + (block_x - origin_x) * setup.span.step[k];
+        const int32_t right = (last_x - block_x) * setup.span.step[k];
+        const int32_t bottom = rows * setup.step_y[k];
+
+        const int32_t min_corner =
+            top_left + std::min(right, 0) + std::min(bottom, 0);
+        const int32_t max_corner =
+            top_left + std::max(right, 0) + std::max(bottom, 0);
+
+        is_outside = is_outside || max_corner < 0;
+        is_inside = is_inside && min_corner >= 0;
+      }
+
+      if (!is_outside) {
+        span_first_x = std::min(span_first_x, block_x);
+        span_last_x = last_x;
+        is_span_inside = is_span_inside && is_inside;
+      }
+    }
+
+    if (span_first_x > span_last_x) {
+      continue;
+    }
+
+    for (int32_t y = block_y; y <= last_y; ++y) {
+      color* const row = pixels + static_cast<size_t>(y) * width + origin_x;
+
+      if (fragments.shade_span) {
+        fragments.shade_span(
+            fragments.shader,
+            setup.span,
+            get_row_start(y),
+            row,
+            origin_x,
+            y,
+            span_first_x - origin_x,
+            span_last_x - origin_x + 1,
+            is_span_inside);
+      } else {
+        m_span_kernel(
+            setup.span,
+            get_row_start(y),
+            row,
+            span_first_x - origin_x,
+            span_last_x - origin_x + 1,
+            is_span_inside);
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void triangle_interpolated_render::rasterize_tiles(
+    const fragment_stage& fragments) {
+  const int32_t width = static_cast<int32_t>(m_canvas.get_width());
+  const int32_t height = static_cast<int32_t>(m_canvas.get_height());
+  const int32_t tiles_x = (width + k_tile_size - 1) / k_tile_size;
+  const int32_t tiles_y = (height + k_tile_size - 1) / k_tile_size;
+
+  m_tiles.resize(static_cast<size_t>(tiles_x) * tiles_y);
+  for (std::vector<uint32_t>& tile : m_tiles) {
+    tile.clear();
+  }
+
+  // Binning by bounds is enough, tiles which a triangle misses are
+  // rejected by the block test right away.
+  for (uint32_t i = 0; i < m_triangles.size(); ++i) {
+    const pixel_rect& bounds = m_triangles[i].bounds;
+
+    for (int32_t y = bounds.min_y / k_tile_size;
+         y <= bounds.max_y / k_tile_size;
+         ++y) {
+      for (int32_t x = bounds.min_x / k_tile_size;
+           x <= bounds.max_x / k_tile_size;
+           ++x) {
+        m_tiles[static_cast<size_t>(y) * tiles_x + x].push_back(i);
+      }
+    }
+  }
+
+  auto rasterize_tile = [this, width, height, tiles_x, &fragments](
+                            const size_t tile) {
+    const int32_t x = static_cast<int32_t>(tile % tiles_x) * k_tile_size;
+    const int32_t y = static_cast<int32_t>(tile / tiles_x) * k_tile_size;
+    const pixel_rect clip{
+        x,
+        y,
+        std::min(x + k_tile_size, width) - 1,
+        std::min(y + k_tile_size, height) - 1,
+    };
+
+    for (const uint32_t i : m_tiles[tile]) {
+      rasterize_triangle(m_triangles[i], clip, fragments);
+    }
+  };
+
+  m_thread_pool->run(m_tiles.size(), rasterize_tile);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void triangle_interpolated_render::render_scanline_triangle(
+    std::array<vertex, 3>& triangle) {
+  const std::vector<vertex> rasterized_vertices =
+      get_rasterized_triangle(triangle);
+
+  for (const vertex& vertex : rasterized_vertices) {
+    const point p{
+        static_cast<int32_t>(std::lround(vertex.x)),
+        static_cast<int32_t>(std::lround(vertex.y)),
+    };
+    const color c{
+        static_cast<unsigned char>(std::lround(vertex.r)),
+        static_cast<unsigned char>(std::lround(vertex.g)),
+        static_cast<unsigned char>(std::lround(vertex.b)),
+    };
+
+    if (p.x < m_clip.min_x || p.y < m_clip.min_y || p.x > m_clip.max_x
+        || p.y > m_clip.max_y) {
+      continue;
+    }
+
+    set_pixel(p, c);
   }
 }
 
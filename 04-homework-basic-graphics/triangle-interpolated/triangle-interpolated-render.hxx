@@ -2,9 +2,15 @@
 
 #include "line-render.hxx"
 #include "my-basic-canvas.hxx"
+#include "span-kernels.hxx"
+#include "thread-pool.hxx"
 
 //
+#include <algorithm>
 #include <array>
+#include <memory>
+#include <optional>
+#include <type_traits>
 #include <utility>
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -23,9 +29,52 @@ struct vertex {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// A shader is any type with
+//   vertex get_vertex_transformed(const vertex&) const;
+//   color get_color_transformed(const vertex&) const;
+// The first one is run for every vertex, the second one for every
+// covered pixel.
+template <typename Shader, typename = void>
+struct is_shader : std::false_type {};
+
+template <typename Shader>
+struct is_shader<
+    Shader,
+    std::void_t<
+        decltype(std::declval<const Shader&>().get_vertex_transformed(
+            std::declval<const vertex&>())),
+        decltype(std::declval<const Shader&>().get_color_transformed(
+            std::declval<const vertex&>()))>>
+  : std::bool_constant<
+        std::is_convertible_v<
+            decltype(std::declval<const Shader&>().get_vertex_transformed(
+                std::declval<const vertex&>())),
+            vertex>
+        && std::is_convertible_v<
+            decltype(std::declval<const Shader&>().get_color_transformed(
+                std::declval<const vertex&>())),
+            color>> {};
+
+template <typename Shader>
+inline constexpr bool is_shader_v = is_shader<Shader>::value;
+
+///////////////////////////////////////////////////////////////////////////////
+
 class triangle_interpolated_render : public line_render {
  public:
-  triangle_interpolated_render(my_canvas& canvas);
+  enum class rasterizer {
+    // Walks the bounding box of a triangle block by block and writes
+    // covered pixels right into the canvas.
+    edge_function,
+    // Splits a triangle into halves with horizontal bases and collects
+    // every pixel of them into a vector first.
+    scanline,
+  };
+
+  triangle_interpolated_render(
+      my_canvas& canvas,
+      const rasterizer type = rasterizer::edge_function);
+  ~triangle_interpolated_render();
 
   triangle_interpolated_render(const triangle_interpolated_render&) = delete;
   triangle_interpolated_render(triangle_interpolated_render&&) = delete;
@@ -38,7 +87,164 @@ class triangle_interpolated_render : public line_render {
       const std::vector<vertex>& vertices,
       const std::vector<uint32_t>& indices);
 
+  // Runs `shader` on every vertex referenced by `indices`, then on every
+  // covered pixel with its coordinates and colors interpolated from the
+  // transformed vertices, clamped to 0..255. Edge function rasterizer
+  // only.
+  //
+  // The pipeline is instantiated for the type of `shader`, so calls of a
+  // final shader class are inlined into the loop over pixels of a span.
+  // Passing a shader by a reference to its virtual base still works, it
+  // just pays a virtual call per vertex and per pixel.
+  template <typename Shader>
+  void render(
+      const Shader& shader,
+      const std::vector<vertex>& vertices,
+      const std::vector<uint32_t>& indices);
+
+  // Counters of the vertex stage of the last edge function `render`
+  // call. Every referenced vertex is transformed and snapped once into a
+  // buffer indexed the same way as the input, so each repeated index is
+  // a hit.
+  struct vertex_cache_stats {
+    size_t indices{};
+    size_t transformed_vertices{};
+
+    double get_hit_rate() const noexcept {
+      return indices
+          ? 1.0 - static_cast<double>(transformed_vertices) / indices
+          : 0.0;
+    }
+  };
+
+  const vertex_cache_stats& get_vertex_cache_stats() const noexcept;
+
+  void set_rasterizer(const rasterizer type);
+
+  // Edge function rasterizer uses the widest supported level by default.
+  void set_simd_level(const simd_level level);
+
+  // Limits drawing to a rectangle of the canvas, in pixels. The whole
+  // canvas by default.
+  void set_scissor(
+      const size_t x,
+      const size_t y,
+      const size_t width,
+      const size_t height);
+  void reset_scissor();
+
+  // With more than 1 thread the edge function rasterizer sorts triangles
+  // into screen tiles first, then tiles are rasterized in parallel. Each
+  // tile is drawn by one thread, triangles in their original order.
+  // 1 thread by default.
+  void set_threads_number(const size_t threads_number);
+
+  // The edge function rasterizer snaps vertices to 1/16 of a pixel
+  // (28.4 fixed point) and follows the top-left fill rule, so triangles
+  // sharing an edge never overlap or leave gaps between them. Edge values
+  // have to fit 32 bits, which holds for canvases up to k_max_coordinate
+  // pixels in each direction and vertices within +-k_guard_band pixels.
+  //
+  // Triangles entirely outside the scissor rectangle are skipped. Those
+  // reaching beyond the guard band are clipped to it, so new edges stay
+  // off the canvas and huge triangles cost no more than the pixels they
+  // cover.
+  static constexpr int32_t k_subpixel_bits{4};
+  static constexpr int32_t k_max_coordinate{2048};
+  static constexpr int32_t k_guard_band{4096};
+
  private:
+  static constexpr int32_t k_tile_size{64};
+
+  // Inclusive bounds of a canvas area.
+  struct pixel_rect {
+    int32_t min_x{};
+    int32_t min_y{};
+    int32_t max_x{};
+    int32_t max_y{};
+  };
+
+  struct triangle_setup;
+
+  // A vertex after the vertex stage together with its position snapped
+  // to the subpixel grid.
+  struct transformed_vertex {
+    vertex v{};
+    int64_t fixed_x{};
+    int64_t fixed_y{};
+    // Inside the guard band, so the fixed point position is valid.
+    bool is_in_range{false};
+  };
+
+  // Vertex stage of `render` without a shader.
+  struct no_vertex_shader {
+    vertex get_vertex_transformed(const vertex& v) const noexcept {
+      return v;
+    }
+  };
+
+  // Shades pixels from `first` up to `count` of a row the same way as
+  // `span_kernel` does, with the fragment shader `shader` points to.
+  // `x` and `y` are canvas coordinates of `pixels`.
+  using fragment_span_function = void (*)(
+      const void* shader,
+      const span_setup& setup,
+      const span_start& start,
+      color* pixels,
+      const int32_t x,
+      const int32_t y,
+      const int32_t first,
+      const int32_t count,
+      const bool is_inside);
+
+  struct fragment_stage {
+    fragment_span_function shade_span{nullptr};
+    const void* shader{nullptr};
+  };
+
+  template <typename Shader>
+  static void shade_fragment_span(
+      const void* shader,
+      const span_setup& setup,
+      const span_start& start,
+      color* pixels,
+      const int32_t x,
+      const int32_t y,
+      const int32_t first,
+      const int32_t count,
+      const bool is_inside);
+
+  // Fills `m_transformed_vertices` for every index of `indices`.
+  template <typename Shader>
+  void transform_vertices(
+      const Shader& shader,
+      const std::vector<vertex>& vertices,
+      const std::vector<uint32_t>& indices);
+  static transformed_vertex get_snapped_vertex(const vertex& v);
+
+  // Sets up triangles of transformed vertices and rasterizes them.
+  // Without a fragment stage pixels get the interpolated colors.
+  void render_transformed(
+      const std::vector<uint32_t>& indices,
+      const fragment_stage& fragments);
+  pixel_rect get_clip_rect() const;
+  // Adds set up triangles to `m_triangles` from `num_triangles` on.
+  void add_triangle(
+      const std::array<const transformed_vertex*, 3>& triangle,
+      size_t& num_triangles);
+  void add_clipped_triangle(
+      const std::array<const transformed_vertex*, 3>& triangle,
+      size_t& num_triangles);
+  bool get_triangle_setup(
+      const std::array<const transformed_vertex*, 3>& triangle,
+      triangle_setup& setup);
+  void rasterize_triangle(
+      const triangle_setup& setup,
+      const pixel_rect& clip,
+      const fragment_stage& fragments);
+  void rasterize_tiles(const fragment_stage& fragments);
+  void render_scanline_triangle(std::array<vertex, 3>& triangle);
+
   std::vector<vertex> get_rasterized_triangle(std::array<vertex, 3>& triangle);
   std::vector<vertex> get_rasterized_horizontal_line(
       const vertex& left,
@@ -50,10 +256,118 @@ class triangle_interpolated_render : public line_render {
       std::array<vertex, 3>& triangle);
   std::vector<vertex> get_rasterized_default_triangle(
       std::array<vertex, 3>& triangle);
+
+  rasterizer m_rasterizer{};
+  std::optional<pixel_rect> m_scissor{};
+  // Scissor rectangle within the canvas for the current `render` call,
+  // empty when `max` is less than `min`.
+  pixel_rect m_clip{};
+  span_kernel m_span_kernel{get_span_kernel(get_supported_simd_level())};
+
+  std::unique_ptr<thread_pool> m_thread_pool{};
+  // Set up triangles of the current `render` call and indices of them
+  // overlapping every tile. Kept between calls to reuse the memory.
+  // `triangle_setup` is complete only in the source file, hence no
+  // initializer here.
+  std::vector<triangle_setup> m_triangles;
+  std::vector<std::vector<uint32_t>> m_tiles{};
+  // Output of the vertex stage, kept between calls the same way. An
+  // entry is valid for the current call when its stamp equals
+  // `m_vertex_stamp`, so nothing has to be cleared per call.
+  std::vector<transformed_vertex> m_transformed_vertices{};
+  std::vector<uint32_t> m_vertex_stamps{};
+  uint32_t m_vertex_stamp{};
+  vertex_cache_stats m_vertex_cache_stats{};
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
+template <typename Shader>
+void triangle_interpolated_render::render(
+    const Shader& shader,
+    const std::vector<vertex>& vertices,
+    const std::vector<uint32_t>& indices) {
+  static_assert(is_shader_v<Shader>, "Shader needs vertex and color stages");
+
+  transform_vertices(shader, vertices, indices);
+  render_transformed(
+      indices,
+      fragment_stage{&shade_fragment_span<Shader>, &shader});
+}
+
+template <typename Shader>
+void triangle_interpolated_render::transform_vertices(
+    const Shader& shader,
+    const std::vector<vertex>& vertices,
+    const std::vector<uint32_t>& indices) {
+  if (m_vertex_stamps.size() < vertices.size()) {
+    m_vertex_stamps.resize(vertices.size());
+    m_transformed_vertices.resize(vertices.size());
+  }
+
+  // Stamps from before the wrap around could match again.
+  if (++m_vertex_stamp == 0) {
+    std::fill(m_vertex_stamps.begin(), m_vertex_stamps.end(), 0);
+    m_vertex_stamp = 1;
+  }
+
+  m_vertex_cache_stats = vertex_cache_stats{indices.size(), 0};
+
+  for (const uint32_t index : indices) {
+    const vertex& v = vertices.at(index);
+
+    if (m_vertex_stamps[index] == m_vertex_stamp) {
+      continue;
+    }
+
+    m_vertex_stamps[index] = m_vertex_stamp;
+    m_transformed_vertices[index] =
+        get_snapped_vertex(shader.get_vertex_transformed(v));
+    ++m_vertex_cache_stats.transformed_vertices;
+  }
+}
+
+template <typename Shader>
+void triangle_interpolated_render::shade_fragment_span(
+    const void* shader,
+    const span_setup& setup,
+    const span_start& start,
+    color* pixels,
+    const int32_t x,
+    const int32_t y,
+    const int32_t first,
+    const int32_t count,
+    const bool is_inside) {
+  const Shader& typed_shader = *static_cast<const Shader*>(shader);
+
+  auto get_channel = [](const float value) {
+    return std::clamp(value, 0.f, 255.f);
+  };
+
+  for (int32_t i = first; i < count; ++i) {
+    const int32_t w0 = start.w[0] + i * setup.step[0];
+    const int32_t w1 = start.w[1] + i * setup.step[1];
+    const int32_t w2 = start.w[2] + i * setup.step[2];
+
+    if (!is_inside && (w0 | w1 | w2) < 0) {
+      continue;
+    }
+
+    const float offset = static_cast<float>(i);
+    const vertex fragment{
+        static_cast<float>(x + i),
+        static_cast<float>(y),
+        get_channel(start.rgb[0] + offset * setup.color_step[0]),
+        get_channel(start.rgb[1] + offset * setup.color_step[1]),
+        get_channel(start.rgb[2] + offset * setup.color_step[2]),
+    };
+
+    pixels[i] = typed_shader.get_color_transformed(fragment);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 } // namespace arci
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,303 @@
+#include "triangle-interpolated-render.hxx"
+
+//
+#include <glog/logging.h>
+
+//
+#include <string_view>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Every triangle of a mesh is drawn alone, and the test counts how many
+// times each pixel was written. Triangles sharing edges must not overlap
+// and must not leave gaps between them.
+
+struct mesh {
+  std::string_view name{};
+  std::vector<arci::vertex> vertices{};
+  std::vector<uint32_t> indices{};
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+constexpr size_t k_width{160};
+constexpr size_t k_height{120};
+
+///////////////////////////////////////////////////////////////////////////////
+
+static arci::vertex get_white_vertex(const float x, const float y) {
+  return arci::vertex{x, y, 255.f, 255.f, 255.f};
+}
+
+// Small deterministic generator, so failures are reproducible.
+static float get_jitter(uint32_t& state, const float amplitude) {
+  state = state * 1664525u + 1013904223u;
+  return amplitude * (static_cast<float>(state >> 8) / (1u << 24) - 0.5f);
+}
+
+// Grid of `cell` pixels between `min` and `max` corners. Inner vertices
+// are moved by up to `jitter` pixels, border ones stay on the border.
+// Every other cell is split along the other diagonal and listed in the
+// other winding order.
+static mesh get_grid_mesh(
+    const std::string_view name,
+    const float min,
+    const float max_x,
+    const float max_y,
+    const uint32_t columns,
+    const uint32_t rows,
+    const float jitter) {
+  mesh result{name, {}, {}};
+  uint32_t state{12345};
+
+  for (uint32_t j = 0; j <= rows; ++j) {
+    for (uint32_t i = 0; i <= columns; ++i) {
+      float x = min + (max_x - min) * i / columns;
+      float y = min + (max_y - min) * j / rows;
+
+      if (i != 0 && i != columns) {
+        x += get_jitter(state, jitter);
+      }
+      if (j != 0 && j != rows) {
+        y += get_jitter(state, jitter);
+      }
+
+      result.vertices.push_back(get_white_vertex(x, y));
+    }
+  }
+
+  for (uint32_t j = 0; j < rows; ++j) {
+    for (uint32_t i = 0; i < columns; ++i) {
+      const uint32_t top_left = j * (columns + 1) + i;
+      const uint32_t top_right = top_left + 1;
+      const uint32_t bottom_left = top_left + columns + 1;
+      const uint32_t bottom_right = bottom_left + 1;
+
+      if ((i + j) % 2 == 0) {
+        result.indices.insert(
+            result.indices.end(),
+            {top_left, top_right, bottom_left,
+             top_right, bottom_right, bottom_left});
+      } else {
+        result.indices.insert(
+            result.indices.end(),
+            {top_left, bottom_right, top_right,
+             top_left, bottom_left, bottom_right});
+      }
+    }
+  }
+
+  return result;
+}
+
+// Grid with its outer vertices far beyond the guard band, so triangles
+// crossing the canvas have to be clipped.
+static mesh get_huge_mesh(const std::string_view name) {
+  const std::array<float, 4> xs{-1e5f, 37.3f, 101.6f, 2.5e6f};
+  const std::array<float, 4> ys{-3e5f, 29.8f, 88.1f, 1e5f};
+
+  mesh result{name, {}, {}};
+
+  for (const float y : ys) {
+    for (const float x : xs) {
+      result.vertices.push_back(get_white_vertex(x, y));
+    }
+  }
+
+  for (uint32_t j = 0; j + 1 < ys.size(); ++j) {
+    for (uint32_t i = 0; i + 1 < xs.size(); ++i) {
+      const uint32_t top_left = j * xs.size() + i;
+      const uint32_t bottom_left = top_left + xs.size();
+      result.indices.insert(
+          result.indices.end(),
+          {top_left, top_left + 1, bottom_left,
+           top_left + 1, bottom_left + 1, bottom_left});
+    }
+  }
+
+  return result;
+}
+
+// Thin triangles around a center point which is not on the pixel grid.
+static mesh get_fan_mesh(const std::string_view name) {
+  constexpr uint32_t k_triangles{37};
+  constexpr float k_pi{3.14159265f};
+  constexpr float k_radius{55.f};
+  const float center_x{k_width / 2.f + 0.3f};
+  const float center_y{k_height / 2.f - 0.2f};
+
+  mesh result{name, {get_white_vertex(center_x, center_y)}, {}};
+
+  for (uint32_t i = 0; i < k_triangles; ++i) {
+    const float angle = 2.f * k_pi * i / k_triangles;
+    result.vertices.push_back(get_white_vertex(
+        center_x + k_radius * std::cos(angle),
+        center_y + k_radius * std::sin(angle)));
+  }
+
+  for (uint32_t i = 0; i < k_triangles; ++i) {
+    result.indices.insert(
+        result.indices.end(),
+        {0, 1 + i, 1 + (i + 1) % k_triangles});
+  }
+
+  return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+static std::vector<uint32_t> get_write_counts(
+    arci::my_canvas& canvas,
+    arci::triangle_interpolated_render& render,
+    const mesh& m) {
+  std::vector<uint32_t> result(k_width * k_height);
+
+  for (size_t i = 0; i < m.indices.size(); i += 3) {
+    canvas.fill_all_with_color({0, 0, 0});
+    render.render(
+        m.vertices,
+        {m.indices.at(i), m.indices.at(i + 1), m.indices.at(i + 2)});
+
+    const std::vector<arci::color>& pixels = canvas.get_pixels();
+    for (size_t p = 0; p < pixels.size(); ++p) {
+      if (!(pixels[p] == arci::color{0, 0, 0})) {
+        ++result[p];
+      }
+    }
+  }
+
+  return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Runs every mesh with the current SIMD level and threads number of
+// `render`, which `setup` names in failure messages.
+static void check_meshes(
+    arci::my_canvas& canvas,
+    arci::triangle_interpolated_render& render,
+    const std::string& setup) {
+  // Pixel centers are at integer coordinates, so a mesh from -0.5 to
+  // size - 0.5 covers the canvas exactly.
+  const std::vector<mesh> covering_meshes{
+      get_grid_mesh(
+          "jittered-grid", -0.5f, k_width - 0.5f, k_height - 0.5f,
+          16, 12, 6.f),
+      get_grid_mesh(
+          "small-cells", -0.5f, k_width - 0.5f, k_height - 0.5f,
+          40, 30, 1.5f),
+      get_huge_mesh("huge"),
+  };
+
+  for (const mesh& m : covering_meshes) {
+    const std::vector<uint32_t> counts = get_write_counts(canvas, render, m);
+
+    for (size_t p = 0; p < counts.size(); ++p) {
+      CHECK_EQ(counts[p], 1u)
+          << "Pixel (" << p % k_width << ", " << p / k_width
+          << ") in mesh " << m.name << ", " << setup;
+    }
+  }
+
+  // Edges through pixel centers. The mesh from 0 to size - 1 owns its
+  // left and top border pixels, but not the right and bottom ones.
+  {
+    const mesh m = get_grid_mesh(
+        "pixel-centers", 0.f, k_width - 1.f, k_height - 1.f, 16, 12, 0.f);
+    const std::vector<uint32_t> counts = get_write_counts(canvas, render, m);
+
+    for (size_t p = 0; p < counts.size(); ++p) {
+      const bool is_owned =
+          p % k_width != k_width - 1 && p / k_width != k_height - 1;
+      CHECK_EQ(counts[p], is_owned ? 1u : 0u)
+          << "Pixel (" << p % k_width << ", " << p / k_width
+          << ") in mesh " << m.name << ", " << setup;
+    }
+  }
+
+  // No pixel of a fan is written twice, and the inner disc has no holes.
+  {
+    const mesh m = get_fan_mesh("fan");
+    const std::vector<uint32_t> counts = get_write_counts(canvas, render, m);
+    const arci::vertex& center = m.vertices.front();
+
+    for (size_t p = 0; p < counts.size(); ++p) {
+      const float dx = static_cast<float>(p % k_width) - center.x;
+      const float dy = static_cast<float>(p / k_width) - center.y;
+
+      CHECK_LE(counts[p], 1u)
+          << "Pixel (" << p % k_width << ", " << p / k_width
+          << ") in mesh " << m.name << ", " << setup;
+      if (std::hypot(dx, dy) < 50.f) {
+        CHECK_EQ(counts[p], 1u)
+            << "Pixel (" << p % k_width << ", " << p / k_width
+            << ") in mesh " << m.name << ", " << setup;
+      }
+    }
+  }
+
+  // Nothing is drawn outside the scissor rectangle.
+  {
+    constexpr size_t k_x{13}, k_y{7};
+    constexpr size_t k_scissor_width{101}, k_scissor_height{50};
+
+    const mesh m = get_huge_mesh("huge-scissored");
+    render.set_scissor(k_x, k_y, k_scissor_width, k_scissor_height);
+    const std::vector<uint32_t> counts = get_write_counts(canvas, render, m);
+    render.reset_scissor();
+
+    for (size_t p = 0; p < counts.size(); ++p) {
+      const size_t x = p % k_width;
+      const size_t y = p / k_width;
+      const bool is_inside = x >= k_x && x < k_x + k_scissor_width
+          && y >= k_y && y < k_y + k_scissor_height;
+      CHECK_EQ(counts[p], is_inside ? 1u : 0u)
+          << "Pixel (" << x << ", " << y << ") in mesh " << m.name
+          << ", " << setup;
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+int main(int, char** argv) {
+  FLAGS_logtostderr = true;
+  google::InitGoogleLogging(argv[0]);
+
+  arci::my_canvas canvas{k_width, k_height, "P6"};
+  arci::triangle_interpolated_render render{canvas};
+
+  // Each SIMD kernel, drawing straight into the canvas and by tiles on
+  // several threads.
+  const std::array<arci::simd_level, 3> simd_levels{
+      arci::simd_level::scalar,
+      arci::simd_level::sse2,
+      arci::simd_level::avx2,
+  };
+  const std::array<size_t, 2> threads_numbers{1, 4};
+
+  for (const arci::simd_level level : simd_levels) {
+    if (!arci::is_simd_level_supported(level)) {
+      continue;
+    }
+
+    for (const size_t threads_number : threads_numbers) {
+      render.set_simd_level(level);
+      render.set_threads_number(threads_number);
+      check_meshes(
+          canvas,
+          render,
+          std::string{arci::get_simd_level_name(level)} + ", "
+              + std::to_string(threads_number) + " threads");
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci::adpcm
+{
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    // IMA-ADPCM stream in 4 bits per sample. Samples are grouped in
+    // independent blocks, so the mixer can decode a sound block by block
+    // while it plays and restart a looped sound without any state from
+    // the previous pass. Each block stores `block_frames` frames. Inside
+    // a block channels are planar: for every channel a 4 byte preamble
+    // (first sample + step index) and then the nibbles of the remaining
+    // samples, low nibble first.
+
+    constexpr char file_magic[4] { 'A', 'R', 'A', 'D' };
+    constexpr std::uint32_t file_version { 1 };
+    constexpr std::uint32_t block_frames { 505 };
+    constexpr std::size_t channel_block_bytes { 4 + (block_frames - 1) / 2 };
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+#pragma pack(push, 1)
+    struct header
+    {
+        char magic[4] {};
+        std::uint32_t version {};
+        std::uint32_t sample_rate {};
+        std::uint16_t channels {};
+        std::uint16_t reserved {};
+        // Number of frames (samples per channel) in the whole stream.
+        std::uint32_t frames {};
+        std::uint32_t blocks {};
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(header) == 24, "ADPCM header should be 24 bytes");
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    // Encodes interleaved signed 16-bit PCM into a complete ADPCM file
+    // (header followed by all blocks).
+    std::vector<std::uint8_t> encode(const std::int16_t* samples,
+                                     const std::size_t frames,
+                                     const std::uint16_t channels,
+                                     const std::uint32_t sample_rate);
+
+    // Checks the header of an ADPCM file. Returns false if `data` isn't
+    // a valid stream. A stream without frames isn't valid either: there
+    // is no block to decode, and a looped voice would never advance.
+    bool parse_header(const std::uint8_t* data,
+                      const std::size_t size,
+                      header& result);
+
+    // Size in bytes of one block with all channels.
+    std::size_t get_block_bytes(const header& stream_header) noexcept;
+
+    // Number of valid frames in the block `index`. Only the last block
+    // may be shorter than `block_frames`.
+    std::size_t get_block_frames(const header& stream_header,
+                                 const std::size_t index) noexcept;
+
+    // Decodes the block `index` of the stream into interleaved signed
+    // 16-bit PCM. `blocks` points right after the header, `out` should
+    // have room for `block_frames * channels` samples. Returns the
+    // number of valid frames written.
+    std::size_t decode_block(const header& stream_header,
+                             const std::uint8_t* blocks,
+                             const std::size_t index,
+                             std::int16_t* out);
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci::adpcm
+
+///////////////////////////////////////////////////////////////////////////////
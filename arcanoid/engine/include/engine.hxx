@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <bitset>
 #include <cstdint>
 #include <optional>
 #include <string_view>
@@ -60,6 +61,10 @@ namespace arci
         button3_released,
         escape_button_pressed,
         escape_button_released,
+        overlay_button_pressed,
+        overlay_button_released,
+        trace_button_pressed,
+        trace_button_released,
     };
 
     enum class keys
@@ -73,7 +78,49 @@ namespace arci
         reduce,
         button1,
         button2,
-        exit
+        debug_overlay,
+        trace_capture,
+        exit,
+        // Not a key: the value of input_event::key for records of other
+        // events. It stays outside the range of input_snapshot.
+        none
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    // Keyboard state latched once per frame by iengine::latch_input().
+    // All queries are bit tests, so systems may ask as often as they like.
+    struct input_snapshot
+    {
+        static constexpr std::size_t keys_number {
+            static_cast<std::size_t>(keys::exit) + 1
+        };
+
+        bool is_held(const keys key) const noexcept
+        {
+            return held.test(static_cast<std::size_t>(key));
+        }
+
+        // Key went down since the previous latch.
+        bool is_pressed(const keys key) const noexcept
+        {
+            return pressed.test(static_cast<std::size_t>(key));
+        }
+
+        // Key went up since the previous latch.
+        bool is_released(const keys key) const noexcept
+        {
+            return released.test(static_cast<std::size_t>(key));
+        }
+
+        std::bitset<keys_number> held {};
+        std::bitset<keys_number> pressed {};
+        std::bitset<keys_number> released {};
+
+        // Latch time of the last state change of every key and of this
+        // snapshot, in nanoseconds since engine start.
+        std::array<std::uint64_t, keys_number> changed_at {};
+        std::uint64_t latched_at {};
     };
 
     ///////////////////////////////////////////////////////////////////////////////
@@ -88,6 +135,30 @@ namespace arci
 
     ///////////////////////////////////////////////////////////////////////////////
 
+    enum class input_event_type : std::uint8_t
+    {
+        quit,
+        key_pressed,
+        key_released,
+        mouse_button_pressed,
+        mouse_button_released,
+    };
+
+    // Plain record filled by iengine::poll_events(). `key` is valid for
+    // key events and is keys::none for all others, `x` and `y` are valid
+    // for mouse events and are zero for all others.
+    struct input_event
+    {
+        input_event_type type;
+        keys key;
+        float x;
+        float y;
+        // Nanoseconds since engine start.
+        std::uint64_t timestamp;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////
+
     struct vertex
     {
         float x {};
@@ -155,16 +226,131 @@ namespace arci
 
     ///////////////////////////////////////////////////////////////////////////////
 
+    // Counters of one frame, from one swap_buffers() call to the next.
+    struct engine_stats
+    {
+        std::uint32_t draw_calls {};
+        std::uint64_t triangles {};
+        std::uint64_t vertex_bytes_uploaded {};
+        std::uint64_t index_bytes_uploaded {};
+        std::uint32_t buffers_created {};
+        std::uint32_t textures_created {};
+        // Draw calls which use another program than the previous one.
+        std::uint32_t shader_switches {};
+        std::uint32_t texture_binds {};
+        // Sounds playing at the last audio callback.
+        std::uint32_t audio_voices {};
+        // Time spent in audio callbacks during the frame.
+        std::uint64_t mixer_time_ns {};
+        // SDL events taken from the queue.
+        std::uint32_t events {};
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    // How GL calls are validated:
+    //   off    - not at all, the same as release builds;
+    //   errors - glGetError() once per frame, cheap but only tells the
+    //            frame where something went wrong;
+    //   trace  - every call is logged with its arguments into a ring
+    //            buffer and checked right away, so a failure reports the
+    //            call site and the calls before it. GL debug output is
+    //            synchronous in this mode only.
+    // Builds without ARCI_GL_VALIDATION (release) are always `off`.
+    enum class gl_validation_mode
+    {
+        off,
+        errors,
+        trace,
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    // Swap interval. With `adaptive` a late frame tears instead of waiting
+    // for the next vblank; drivers without it fall back to `on`.
+    enum class vsync_mode
+    {
+        off,
+        on,
+        adaptive,
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    struct engine_options
+    {
+        // Run without a display and a sound card: the window is created
+        // hidden by the SDL `offscreen` video driver (EGL pbuffer, works on
+        // software GL too), vsync is off and the mixer is driven by a
+        // simulated clock instead of the audio device.
+        bool headless { false };
+
+        // Time which passes for the null audio device on every
+        // swap_buffers() call in headless mode.
+        float simulated_frame_time { 1.f / 60.f };
+
+        std::size_t window_width { 1024 };
+        std::size_t window_height { 768 };
+
+        // Requested core profile version.
+        int gl_major_version { 3 };
+        int gl_minor_version { 2 };
+
+        // A smaller device buffer lowers the audio latency and raises the
+        // risk of underruns.
+        int audio_sample_rate { 48000 };
+        std::uint16_t audio_buffer_samples { 4096 };
+
+        // Ignored in headless mode, which never waits for vsync.
+        vsync_mode vsync { vsync_mode::on };
+
+#ifdef ARCI_GL_VALIDATION
+        gl_validation_mode gl_validation { gl_validation_mode::trace };
+#else
+        gl_validation_mode gl_validation { gl_validation_mode::off };
+#endif
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////
+
     class iengine
     {
     public:
         virtual ~iengine() = default;
-        virtual void init() = 0;
+        virtual void init(const engine_options& options) = 0;
         virtual bool process_input(event& event) = 0;
+
+        // Drains pending events into `events` in one call. Returns the
+        // number of records written: when it equals `capacity` there may
+        // be more events, otherwise the queue is empty. Events of unbound
+        // keys and other devices are consumed without a record.
+        virtual std::size_t poll_events(input_event* events,
+                                        const std::size_t capacity)
+            = 0;
         virtual bool key_down(const enum keys key) = 0;
+
+        // Sleeps until an event arrives or `timeout_ms` passes, the events
+        // are left for poll_events(). Returns true if there are events.
+        // Never sleeps in headless mode.
+        virtual bool wait_events(const std::uint32_t timeout_ms) = 0;
+
+        // Samples the keyboard into the input snapshot. Call it once per
+        // frame right before the simulation, after the events are pumped.
+        virtual void latch_input() = 0;
+        virtual const input_snapshot& get_input() const noexcept = 0;
         virtual void imgui_new_frame() = 0;
         virtual void imgui_render() = 0;
 
+        // Statistics of the last finished frame.
+        virtual const engine_stats& get_stats() const noexcept = 0;
+
+        // GPU time of the commands issued between these calls is
+        // reported to the profiler as the counter `name` (a string
+        // literal), a few frames later. Passes can't be nested, ImGui is
+        // measured by the engine as "gpu/imgui".
+        virtual void begin_gpu_pass(const char* name) = 0;
+        virtual void end_gpu_pass() = 0;
+
         /* clang-format off */
         virtual void render(ivertex_buffer* vertex_buffer,
                             i_index_buffer* ebo,    
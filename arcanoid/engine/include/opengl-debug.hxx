@@ -1,5 +1,6 @@
 #pragma once
 
+#include <engine.hxx>
 #include <helper.hxx>
 
 #include <glad/glad.h>
@@ -10,6 +11,17 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Checks the preceding GL call. It's a macro so that failures point at
+// the call site, and `opengl_check()` as well as `arci::opengl_check()`
+// keep working.
+#ifdef ARCI_GL_VALIDATION
+#define opengl_check() opengl_check_at(__FILE__, __LINE__)
+#else
+#define opengl_check() opengl_check_at()
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
 namespace arci
 {
 
@@ -148,52 +160,43 @@ namespace arci
         return result;
     }
 
-    inline static void opengl_check()
+    // Validation of GL calls, see engine_options::gl_validation. With
+    // ARCI_GL_VALIDATION undefined (release builds) opengl_check() is an
+    // empty inline function and nothing else is installed.
+    namespace gl_validation
     {
-        const GLenum error = glGetError();
+        // Set by init() in the `trace` mode only.
+        inline bool check_each_call { false };
 
-        if (error == GL_NO_ERROR)
-        {
-            return;
-        }
+        // Should be called right after the GL functions are loaded.
+        void init(const gl_validation_mode mode);
 
-        switch (error)
+        gl_validation_mode get_mode() noexcept;
+
+        // Collects the errors of the whole frame in the `errors` mode.
+        // Call it once per frame.
+        void end_frame();
+
+        // Reports the error (if any) with the call site and the last
+        // traced GL calls, then exits.
+        void check(const char* file, const int line);
+
+        std::string error_to_string(const GLenum error);
+    }
+
+#ifdef ARCI_GL_VALIDATION
+    inline void opengl_check_at(const char* file, const int line)
+    {
+        if (gl_validation::check_each_call)
         {
-        case GL_INVALID_ENUM:
-            fmt::print("An unacceptable value is specified"
-                       " for an enumerated argument\n");
-            break;
-        case GL_INVALID_VALUE:
-            fmt::print("A numeric argument is out of range\n");
-            break;
-        case GL_INVALID_OPERATION:
-            fmt::print("The specified operation is not"
-                       " allowed in the current state\n");
-            break;
-        case GL_INVALID_FRAMEBUFFER_OPERATION:
-            fmt::print("The framebuffer object is not complete\n");
-            break;
-        case GL_OUT_OF_MEMORY:
-            fmt::print("There is not enough memory left to execute"
-                       " the command\n");
-            break;
-        case GL_STACK_UNDERFLOW:
-            fmt::print("An attempt has been made to perform"
-                       " an operation that would cause an internal"
-                       " stack to underflow\n");
-            break;
-        case GL_STACK_OVERFLOW:
-            fmt::print("An attempt has been made to perform"
-                       " an operation that would cause an internal"
-                       " stack to overflow\n");
-            break;
-        default:
-            fmt::print("Undefined opengl error type\n");
-            break;
+            gl_validation::check(file, line);
         }
-
-        std::exit(1);
     }
+#else
+    inline void opengl_check_at() noexcept
+    {
+    }
+#endif
 
     ///////////////////////////////////////////////////////////////////////////////
 
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "glad/glad.h"
+
+#include <array>
+#include <cstddef>
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci
+{
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    // Measures GPU time of render passes with GL_TIME_ELAPSED queries
+    // (GL_ARB_timer_query on desktop, GL_EXT_disjoint_timer_query on ES).
+    // Every frame gets its own set of query objects and results are read
+    // `frames_in_flight - 1` frames later, only if the driver has them
+    // ready, so the CPU never waits for the GPU. Resolved pass times go to
+    // the profiler as counters named after the passes.
+    //
+    // Without the extension (e.g. llvmpipe) or with the profiler compiled
+    // out all calls do nothing.
+    class opengl_gpu_timer final
+    {
+    public:
+        opengl_gpu_timer() = default;
+        opengl_gpu_timer(const opengl_gpu_timer&) = delete;
+        opengl_gpu_timer& operator=(const opengl_gpu_timer&) = delete;
+
+        // Should be called with a current context.
+        void init();
+        void uninit();
+
+        bool is_supported() const noexcept;
+
+        // Passes can't be nested. `name` should be a string literal.
+        void begin_pass(const char* name);
+        void end_pass();
+
+        // Closes the current frame, call it right before the swap.
+        void end_frame();
+
+    private:
+        static constexpr std::size_t frames_in_flight { 4 };
+        static constexpr std::size_t max_passes { 8 };
+
+        struct frame_queries
+        {
+            std::array<GLuint, max_passes> queries {};
+            std::array<const char*, max_passes> names {};
+            std::size_t passes {};
+        };
+
+        void resolve_frame(frame_queries& frame);
+
+        std::array<frame_queries, frames_in_flight> m_frames {};
+        std::size_t m_frame_index {};
+        bool m_is_supported { false };
+        bool m_is_disjoint_ext { false };
+        bool m_in_pass { false };
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+///////////////////////////////////////////////////////////////////////////////
+
+// CPU scope profiler. A zone is opened with ARCI_PROFILE_SCOPE("name") and
+// closed at the end of the enclosing block. Every thread writes its zones
+// into its own lock-free ring buffer, the main thread drains all of them
+// once per frame in profiler::end_frame().
+//
+// ARCI_PROFILE_COUNTER("name", value) samples a counter into the same
+// stream. Counters are shown in the panel and, together with zones and
+// thread names, streamed into a Chrome trace (chrome://tracing, Perfetto)
+// between start_trace() and stop_trace().
+//
+// Zones are compiled in only when ARCI_PROFILER is defined (debug builds,
+// or release ones configured with -DARCI_PROFILER=ON). Otherwise the
+// macros expand to nothing and the functions below do nothing.
+
+#define ARCI_PROFILER_CONCAT_IMPL(a, b) a##b
+#define ARCI_PROFILER_CONCAT(a, b) ARCI_PROFILER_CONCAT_IMPL(a, b)
+
+#ifdef ARCI_PROFILER
+// `name` should be a string literal: only the pointer is recorded.
+#define ARCI_PROFILE_SCOPE(name)                                              \
+    const ::arci::profiler::scope ARCI_PROFILER_CONCAT(profile_scope_,       \
+                                                       __LINE__)             \
+    {                                                                         \
+        name                                                                  \
+    }
+#define ARCI_PROFILE_THREAD(name) ::arci::profiler::set_thread_name(name)
+#define ARCI_PROFILE_COUNTER(name, value)                                     \
+    ::arci::profiler::add_counter(name, static_cast<double>(value))
+#else
+#define ARCI_PROFILE_SCOPE(name) static_cast<void>(0)
+#define ARCI_PROFILE_THREAD(name) static_cast<void>(0)
+#define ARCI_PROFILE_COUNTER(name, value) static_cast<void>(0)
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci::profiler
+{
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    struct zone_record
+    {
+        const char* name {};
+        // Nanoseconds since profiler start.
+        std::uint64_t start {};
+        std::uint64_t end {};
+        std::uint32_t depth {};
+        // Index of the thread in the profiler registry, threads are
+        // registered by their first zone.
+        std::uint32_t thread {};
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    // Nanoseconds since profiler start, steady clock.
+    std::uint64_t now() noexcept;
+
+    // Names the calling thread in the panel. `name` should be a string
+    // literal. Cheap enough to be called on every audio callback.
+    void set_thread_name(const char* name) noexcept;
+
+    // Records a counter sample at the current time. `name` should be a
+    // string literal.
+    void add_counter(const char* name, const double value) noexcept;
+
+    // Drains the zone buffers of all threads and updates the statistics.
+    // Call it once per frame from the main thread.
+    void end_frame();
+
+    // Draws the profiler window. Should be called between
+    // iengine::imgui_new_frame() and iengine::imgui_render().
+    void draw_panel();
+
+    // Starts streaming everything recorded into the Chrome trace JSON
+    // file `path`. The file is written by a background thread, at most a
+    // few megabytes of events are queued for it: if the disk can't keep
+    // up, the excess is dropped and counted. Returns false if the
+    // profiler is compiled out or the file can't be opened.
+    bool start_trace(const char* path);
+
+    // Flushes and closes the trace. Does nothing if there is no trace.
+    void stop_trace();
+
+    bool is_tracing() noexcept;
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    class scope
+    {
+    public:
+        explicit scope(const char* name) noexcept;
+        ~scope();
+
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+
+    private:
+        const char* m_name {};
+        std::uint64_t m_start {};
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci::profiler
+
+///////////////////////////////////////////////////////////////////////////////
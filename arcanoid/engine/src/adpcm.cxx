@@ -0,0 +1,241 @@
+#include "adpcm.hxx"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci::adpcm
+{
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    static constexpr std::array<std::int32_t, 89> step_table {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+        19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+        50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+        130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+        337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+        876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+        2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+        5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+        15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+    };
+
+    static constexpr std::array<std::int32_t, 16> index_table {
+        -1, -1, -1, -1, 2, 4, 6, 8,
+        -1, -1, -1, -1, 2, 4, 6, 8
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    struct channel_state
+    {
+        std::int32_t predictor {};
+        std::int32_t step_index {};
+    };
+
+    // Shared by the encoder and the decoder so that both always
+    // reconstruct exactly the same signal. The difference is computed
+    // with a multiply instead of the classic chain of bit tests and the
+    // sign is applied with a mask, so the loop has no data dependent
+    // branches.
+    static inline std::int16_t apply_nibble(channel_state& state,
+                                            const std::uint8_t code)
+    {
+        const std::int32_t step = step_table[state.step_index];
+        const std::int32_t diff = ((2 * (code & 7) + 1) * step) >> 3;
+        const std::int32_t sign = -static_cast<std::int32_t>(code >> 3);
+
+        state.predictor = std::clamp(state.predictor + ((diff ^ sign) - sign),
+                                     -32768,
+                                     32767);
+        state.step_index = std::clamp(state.step_index + index_table[code],
+                                      0,
+                                      88);
+
+        return static_cast<std::int16_t>(state.predictor);
+    }
+
+    static std::uint8_t encode_sample(channel_state& state,
+                                      const std::int16_t sample)
+    {
+        const std::int32_t step = step_table[state.step_index];
+        std::int32_t diff = sample - state.predictor;
+        std::uint8_t code { 0 };
+
+        if (diff < 0)
+        {
+            code = 8;
+            diff = -diff;
+        }
+
+        // Pick the magnitude which reconstructs closest to the sample:
+        // ((2 * m + 1) * step) / 8 ~ diff gives m = 4 * diff / step.
+        const std::int32_t magnitude = std::clamp((4 * diff) / step, 0, 7);
+        code |= static_cast<std::uint8_t>(magnitude);
+
+        apply_nibble(state, code);
+
+        return code;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    std::size_t get_block_bytes(const header& stream_header) noexcept
+    {
+        return channel_block_bytes * stream_header.channels;
+    }
+
+    std::size_t get_block_frames(const header& stream_header,
+                                 const std::size_t index) noexcept
+    {
+        const std::size_t first_frame = index * block_frames;
+
+        if (first_frame >= stream_header.frames)
+        {
+            return 0;
+        }
+
+        return std::min<std::size_t>(block_frames,
+                                     stream_header.frames - first_frame);
+    }
+
+    std::vector<std::uint8_t> encode(const std::int16_t* samples,
+                                     const std::size_t frames,
+                                     const std::uint16_t channels,
+                                     const std::uint32_t sample_rate)
+    {
+        header stream_header {};
+        std::memcpy(stream_header.magic, file_magic, sizeof(file_magic));
+        stream_header.version = file_version;
+        stream_header.sample_rate = sample_rate;
+        stream_header.channels = channels;
+        stream_header.frames = static_cast<std::uint32_t>(frames);
+        stream_header.blocks = static_cast<std::uint32_t>(
+            (frames + block_frames - 1) / block_frames);
+
+        const std::size_t block_bytes = get_block_bytes(stream_header);
+
+        std::vector<std::uint8_t> result(
+            sizeof(header) + block_bytes * stream_header.blocks);
+        std::memcpy(result.data(), &stream_header, sizeof(header));
+
+        // Step index is carried over from block to block: it makes the
+        // start of every block adapt faster to the signal.
+        std::vector<channel_state> states(channels);
+
+        for (std::size_t block = 0; block < stream_header.blocks; ++block)
+        {
+            std::uint8_t* block_data = result.data()
+                + sizeof(header)
+                + block * block_bytes;
+
+            const std::size_t first_frame = block * block_frames;
+
+            auto get_sample = [&](const std::size_t frame,
+                                  const std::size_t channel) -> std::int16_t {
+                const std::size_t index = first_frame + frame;
+                return index < frames ? samples[index * channels + channel]
+                                      : std::int16_t { 0 };
+            };
+
+            for (std::size_t channel = 0; channel < channels; ++channel)
+            {
+                std::uint8_t* out = block_data + channel * channel_block_bytes;
+                channel_state& state = states[channel];
+
+                const std::int16_t first_sample = get_sample(0, channel);
+                state.predictor = first_sample;
+
+                out[0] = static_cast<std::uint8_t>(first_sample & 0xff);
+                out[1] = static_cast<std::uint8_t>((first_sample >> 8) & 0xff);
+                out[2] = static_cast<std::uint8_t>(state.step_index);
+                out[3] = 0;
+
+                for (std::size_t frame = 1; frame < block_frames; frame += 2)
+                {
+                    const std::uint8_t low
+                        = encode_sample(state, get_sample(frame, channel));
+                    const std::uint8_t high
+                        = encode_sample(state, get_sample(frame + 1, channel));
+                    out[4 + frame / 2] = static_cast<std::uint8_t>(
+                        low | (high << 4));
+                }
+            }
+        }
+
+        return result;
+    }
+
+    bool parse_header(const std::uint8_t* data,
+                      const std::size_t size,
+                      header& result)
+    {
+        if (data == nullptr || size < sizeof(header))
+        {
+            return false;
+        }
+
+        std::memcpy(&result, data, sizeof(header));
+
+        if (std::memcmp(result.magic, file_magic, sizeof(file_magic)) != 0
+            || result.version != file_version
+            || result.channels == 0
+            || result.sample_rate == 0
+            || result.frames == 0)
+        {
+            return false;
+        }
+
+        const std::size_t expected_blocks
+            = (static_cast<std::size_t>(result.frames) + block_frames - 1)
+            / block_frames;
+
+        return result.blocks == expected_blocks
+            && size >= sizeof(header) + get_block_bytes(result) * result.blocks;
+    }
+
+    std::size_t decode_block(const header& stream_header,
+                             const std::uint8_t* blocks,
+                             const std::size_t index,
+                             std::int16_t* out)
+    {
+        const std::size_t channels = stream_header.channels;
+        const std::uint8_t* block_data = blocks
+            + index * get_block_bytes(stream_header);
+
+        // Channels are independent, so each one is decoded in its own
+        // tight loop with the state kept in registers.
+        for (std::size_t channel = 0; channel < channels; ++channel)
+        {
+            const std::uint8_t* in = block_data
+                + channel * channel_block_bytes;
+            std::int16_t* dst = out + channel;
+
+            channel_state state {};
+            state.predictor = static_cast<std::int16_t>(
+                in[0] | (in[1] << 8));
+            state.step_index = std::min<std::int32_t>(in[2], 88);
+
+            dst[0] = static_cast<std::int16_t>(state.predictor);
+            dst += channels;
+
+            for (std::size_t i = 4; i < channel_block_bytes; ++i)
+            {
+                const std::uint8_t byte = in[i];
+                dst[0] = apply_nibble(state, byte & 0x0f);
+                dst[channels] = apply_nibble(state, byte >> 4);
+                dst += 2 * channels;
+            }
+        }
+
+        return get_block_frames(stream_header, index);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci::adpcm
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,79 @@
+#include "FrameHistogram.hxx"
+
+#include <algorithm>
+
+cFrameHistogram::cFrameHistogram(size_t windowSize)
+    : m_frames(std::max<size_t>(windowSize, 1), 0)
+{
+}
+
+void cFrameHistogram::reset()
+{
+    std::fill(m_frames.begin(), m_frames.end(), 0);
+    m_next = 0;
+    m_count = 0;
+    m_totalHitches = 0;
+}
+
+void cFrameHistogram::addFrame(uint64_t frameTime)
+{
+    m_frames[m_next] = frameTime;
+    m_next = (m_next + 1) % m_frames.size();
+    m_count = std::min(m_count + 1, m_frames.size());
+
+    if (frameTime > m_hitchThreshold)
+    {
+        m_totalHitches++;
+    }
+}
+
+void cFrameHistogram::setHitchThreshold(uint64_t threshold)
+{
+    m_hitchThreshold = threshold;
+}
+
+uint64_t cFrameHistogram::getHitchThreshold() const
+{
+    return m_hitchThreshold;
+}
+
+cFrameHistogram::Stats cFrameHistogram::getStats() const
+{
+    Stats stats;
+    stats.frames = static_cast<uint32_t>(m_count);
+    stats.totalHitches = m_totalHitches;
+
+    if (m_count == 0)
+    {
+        return stats;
+    }
+
+    m_sorted.assign(m_frames.begin(), m_frames.begin() + m_count);
+    std::sort(m_sorted.begin(), m_sorted.end());
+
+    auto percentile = [this](size_t percent) {
+        const size_t index = (m_sorted.size() - 1) * percent / 100;
+        return m_sorted[index];
+    };
+
+    stats.p50 = percentile(50);
+    stats.p95 = percentile(95);
+    stats.p99 = percentile(99);
+    stats.max = m_sorted.back();
+    stats.windowHitches = static_cast<uint32_t>(
+        m_sorted.end()
+        - std::upper_bound(m_sorted.begin(), m_sorted.end(), m_hitchThreshold));
+
+    return stats;
+}
+
+void cFrameHistogram::getFrameTimesMs(std::vector<float>& result) const
+{
+    result.resize(m_count);
+
+    const size_t first = m_count < m_frames.size() ? 0 : m_next;
+    for (size_t i = 0; i < m_count; i++)
+    {
+        result[i] = m_frames[(first + i) % m_frames.size()] * 0.000001f;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Rolling window of the last frame times with percentiles and
+ * hitch counting. Adding a frame is O(1), percentiles are computed only
+ * when asked for.
+ */
+class cFrameHistogram
+{
+public:
+    struct Stats
+    {
+        uint64_t p50 = 0;
+        uint64_t p95 = 0;
+        uint64_t p99 = 0;
+        uint64_t max = 0;
+        // Hitches inside the window and since the last reset.
+        uint32_t windowHitches = 0;
+        uint64_t totalHitches = 0;
+        uint32_t frames = 0;
+    };
+
+    explicit cFrameHistogram(size_t windowSize = 600);
+
+    void reset();
+
+    /**
+     * @brief add time of one frame.
+     * @param frameTime time in nanoseconds.
+     */
+    void addFrame(uint64_t frameTime);
+
+    /**
+     * @brief frames longer than this are counted as hitches.
+     * @param threshold time in nanoseconds.
+     */
+    void setHitchThreshold(uint64_t threshold);
+    uint64_t getHitchThreshold() const;
+
+    /**
+     * @brief percentiles over the window.
+     * @return times in nanoseconds.
+     */
+    Stats getStats() const;
+
+    /**
+     * @brief frame times of the window from the oldest to the newest.
+     * @param result times in milliseconds, resized to the frame count.
+     */
+    void getFrameTimesMs(std::vector<float>& result) const;
+
+private:
+    std::vector<uint64_t> m_frames;
+    size_t m_next = 0;
+    size_t m_count = 0;
+
+    uint64_t m_hitchThreshold = 33'333'333;
+    uint64_t m_totalHitches = 0;
+
+    mutable std::vector<uint64_t> m_sorted;
+};
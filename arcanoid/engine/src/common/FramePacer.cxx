@@ -0,0 +1,59 @@
+#include "FramePacer.hxx"
+#include "Timer.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+    constexpr uint64_t minSpinTime = 200'000;
+    constexpr uint64_t maxSpinTime = 4'000'000;
+}
+
+void cFramePacer::setTargetFps(uint32_t fps)
+{
+    m_targetFps = fps;
+    m_period = fps != 0 ? 1'000'000'000ull / fps : 0;
+    m_deadline = 0;
+    m_spinTime = 1'000'000;
+}
+
+uint32_t cFramePacer::getTargetFps() const
+{
+    return m_targetFps;
+}
+
+void cFramePacer::wait()
+{
+    if (m_period == 0)
+    {
+        return;
+    }
+
+    uint64_t now = cTimer::getCurrentTime();
+    m_deadline += m_period;
+
+    if (m_deadline <= now)
+    {
+        m_deadline = now;
+        return;
+    }
+
+    if (m_deadline - now > m_spinTime)
+    {
+        const uint64_t sleepTime = m_deadline - now - m_spinTime;
+        std::this_thread::sleep_for(std::chrono::nanoseconds(sleepTime));
+
+        // Let the spin part shrink slowly after a bad wake up.
+        const uint64_t slept = cTimer::getCurrentTime() - now;
+        const uint64_t oversleep = slept > sleepTime ? slept - sleepTime : 0;
+        m_spinTime = std::max(oversleep + oversleep / 4, m_spinTime - m_spinTime / 64);
+        m_spinTime = std::clamp(m_spinTime, minSpinTime, maxSpinTime);
+    }
+
+    while (cTimer::getCurrentTime() < m_deadline)
+    {
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Caps the frame rate. Sleeps through most of the remaining frame
+ * time and spins the last part, because sleep wakes up late by up to a
+ * scheduler tick. The spin part follows the worst recent oversleep.
+ */
+class cFramePacer
+{
+public:
+    /**
+     * @brief set the target frame rate.
+     * @param fps frames per second, 0 turns the cap off.
+     */
+    void setTargetFps(uint32_t fps);
+
+    uint32_t getTargetFps() const;
+
+    /**
+     * @brief wait until the current frame has taken its time. A frame
+     * which is already late starts a new schedule, late frames aren't
+     * made up by running the next ones faster.
+     */
+    void wait();
+
+private:
+    uint32_t m_targetFps = 0;
+    uint64_t m_period = 0;
+    uint64_t m_deadline = 0;
+    uint64_t m_spinTime = 0;
+};
@@ -5,19 +5,24 @@ void cFrameTimer::restart()
     m_timer.start();
     m_lastTime = m_timer.getCurrentTime();
     m_frame = 0;
+    m_frameDeltaNs = 0;
     m_frameDelta = 0.0f;
     m_countingTime = 0.0f;
     m_fps = 0.0f;
+    m_histogram.reset();
 }
 
 void cFrameTimer::update()
 {
-    const uint32_t currentTime = m_timer.getCurrentTime();
-    const float dt = (currentTime - m_lastTime) * 0.000001f;
+    const uint64_t currentTime = m_timer.getCurrentTime();
+    const uint64_t deltaNs = currentTime - m_lastTime;
+    const float dt = deltaNs * 0.000000001f;
     m_lastTime = currentTime;
 
     m_frame++;
+    m_frameDeltaNs = deltaNs;
     m_frameDelta = dt;
+    m_histogram.addFrame(deltaNs);
 
     m_countingTime += dt;
     if (m_countingTime >= 1.0f)
@@ -36,4 +41,19 @@ float cFrameTimer::getFrameDeltaTime() const
 float cFrameTimer::getFps() const
 {
     return m_fps;
+}
+
+uint64_t cFrameTimer::getFrameDeltaNs() const
+{
+    return m_frameDeltaNs;
+}
+
+const cFrameHistogram& cFrameTimer::getHistogram() const
+{
+    return m_histogram;
+}
+
+cFrameHistogram& cFrameTimer::getHistogram()
+{
+    return m_histogram;
 }
\ No newline at end of file
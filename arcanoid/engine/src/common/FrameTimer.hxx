@@ -1,5 +1,6 @@
 #pragma once
 
+#include "FrameHistogram.hxx"
 #include "Timer.hxx"
 
 class cFrameTimer
@@ -11,13 +12,24 @@ public:
     float getFrameDeltaTime() const;
     float getFps() const;
 
+    /**
+     * @brief last frame time.
+     * @return time in nanoseconds.
+     */
+    uint64_t getFrameDeltaNs() const;
+
+    const cFrameHistogram& getHistogram() const;
+    cFrameHistogram& getHistogram();
+
 private:
     cTimer m_timer;
+    cFrameHistogram m_histogram;
 
-    uint32_t m_lastTime;
-    uint32_t m_frame;
+    uint64_t m_lastTime = 0;
+    uint64_t m_frameDeltaNs = 0;
+    uint32_t m_frame = 0;
 
-    float m_frameDelta;
-    float m_countingTime;
-    float m_fps;
+    float m_frameDelta = 0.0f;
+    float m_countingTime = 0.0f;
+    float m_fps = 0.0f;
 };
@@ -17,25 +17,25 @@ bool cTimer::isStarted() const
     return m_isStarted;
 }
 
-uint32_t cTimer::getCurrentDelta() const
+uint64_t cTimer::getCurrentDelta() const
 {
     auto currentTime = Clock::now();
     return getDelta(m_start, currentTime);
 }
 
-uint32_t cTimer::getDelta() const
+uint64_t cTimer::getDelta() const
 {
     return getDelta(m_start, m_stop);
 }
 
-uint32_t cTimer::getDelta(const TimePoint& begin, const TimePoint& end) const
+uint64_t cTimer::getDelta(const TimePoint& begin, const TimePoint& end) const
 {
-    auto deltaTime = std::chrono::duration_cast<Us>(end - begin);
-    return static_cast<uint32_t>(deltaTime.count());
+    auto deltaTime = std::chrono::duration_cast<Ns>(end - begin);
+    return static_cast<uint64_t>(deltaTime.count());
 }
 
-uint32_t cTimer::getCurrentTime()
+uint64_t cTimer::getCurrentTime()
 {
-    auto currentTime = std::chrono::duration_cast<Us>(Clock::now().time_since_epoch());
-    return static_cast<uint32_t>(currentTime.count());
+    auto currentTime = std::chrono::duration_cast<Ns>(Clock::now().time_since_epoch());
+    return static_cast<uint64_t>(currentTime.count());
 }
\ No newline at end of file
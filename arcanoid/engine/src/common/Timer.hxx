@@ -1,6 +1,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 
 class cTimer
 {
@@ -12,33 +13,32 @@ public:
 
     /**
      * @brief delta time between start and current.
-     * @return time in microseconds.
+     * @return time in nanoseconds.
      */
-    uint32_t getCurrentDelta() const;
+    uint64_t getCurrentDelta() const;
 
     /**
      * @brief delta time between start and stop.
-     * @return time in microseconds.
+     * @return time in nanoseconds.
      */
-    uint32_t getDelta() const;
+    uint64_t getDelta() const;
 
     /**
-     * @brief System time.
-     * @return time in microseconds.
+     * @brief Monotonic time, not related to the wall clock.
+     * @return time in nanoseconds.
      */
-    static uint32_t getCurrentTime();
+    static uint64_t getCurrentTime();
 
 private:
-    using Clock = std::chrono::high_resolution_clock;
-    using MSec = std::chrono::milliseconds;
-    using Us = std::chrono::microseconds;
+    using Clock = std::chrono::steady_clock;
+    using Ns = std::chrono::nanoseconds;
 
     using TimePoint = Clock::time_point;
-    uint32_t getDelta(const TimePoint& begin, const TimePoint& end) const;
+    uint64_t getDelta(const TimePoint& begin, const TimePoint& end) const;
 
 private:
     bool m_isStarted = false;
 
     TimePoint m_start;
     TimePoint m_stop;
-};
\ No newline at end of file
+};
@@ -1,7 +1,10 @@
 #include "engine.hxx"
+#include "adpcm.hxx"
 #include "glad/glad.h"
 #include "opengl-debug.hxx"
+#include "opengl-gpu-timer.hxx"
 #include "opengl-shader-programm.hxx"
+#include "profiler.hxx"
 
 //
 #include <SDL3/SDL.h>
@@ -16,8 +19,10 @@
 //
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <memory>
@@ -45,7 +50,7 @@ namespace arci
 
     ///////////////////////////////////////////////////////////////////////////////
 
-    const std::array<bind_key, 8> keys {
+    const std::array<bind_key, 10> keys {
         bind_key {
             "left",
             SDLK_LEFT,
@@ -95,6 +100,20 @@ namespace arci
             key_event::button3_released,
             keys::reduce,
         },
+        bind_key {
+            "f1",
+            SDLK_F1,
+            key_event::overlay_button_pressed,
+            key_event::overlay_button_released,
+            keys::debug_overlay,
+        },
+        bind_key {
+            "f2",
+            SDLK_F2,
+            key_event::trace_button_pressed,
+            key_event::trace_button_released,
+            keys::trace_capture,
+        },
         bind_key {
             "escape",
             SDLK_ESCAPE,
@@ -275,6 +294,15 @@ namespace arci
         running_mode mode { running_mode::once };
         bool is_running { false };
 
+        // Sounds loaded from `.adpcm` files stay compressed in memory and
+        // the mixer decodes them block by block while they are playing.
+        // For such sounds `current_position` is a frame in `decoded_block`.
+        std::vector<std::uint8_t> compressed {};
+        adpcm::header compressed_header {};
+        std::vector<std::int16_t> decoded_block {};
+        std::size_t decoded_frames {};
+        std::size_t next_block {};
+
         audio_buffer(const std::string_view audio_file_name,
                      const SDL_AudioSpec& desired_audio_spec);
         ~audio_buffer()
@@ -286,9 +314,24 @@ namespace arci
         {
             std::lock_guard<std::mutex> lock { audio_mutex };
             current_position = 0;
+            decoded_frames = 0;
+            next_block = 0;
             is_running = true;
             this->mode = mode;
         }
+
+        bool is_compressed() const noexcept
+        {
+            return !compressed.empty();
+        }
+
+    private:
+        void load_wav(const std::string_view audio_file_name,
+                      const SDL_AudioSpec& desired_audio_spec);
+        void load_adpcm(const std::string_view audio_file_name,
+                        const SDL_AudioSpec& desired_audio_spec);
+        void convert(const SDL_AudioSpec& audio_spec,
+                     const SDL_AudioSpec& desired_audio_spec);
     };
 
     ///////////////////////////////////////////////////////////////////////////////
@@ -302,11 +345,19 @@ namespace arci
         engine_using_sdl& operator=(const engine_using_sdl&) = delete;
         engine_using_sdl& operator=(engine_using_sdl&&) = delete;
 
-        void init() override;
+        void init(const engine_options& options) override;
         bool process_input(event& event) override;
+        std::size_t poll_events(input_event* events,
+                                const std::size_t capacity) override;
         bool key_down(const enum keys key) override;
+        bool wait_events(const std::uint32_t timeout_ms) override;
+        void latch_input() override;
+        const input_snapshot& get_input() const noexcept override;
         void imgui_new_frame() override;
         void imgui_render() override;
+        const engine_stats& get_stats() const noexcept override;
+        void begin_gpu_pass(const char* name) override;
+        void end_gpu_pass() override;
         void render(ivertex_buffer* vertex_buffer,
                     i_index_buffer* ebo,
                     itexture* const texture,
@@ -339,6 +390,15 @@ namespace arci
     private:
         std::optional<bind_key> get_key_for_event(
             const SDL_Event& sdl_event);
+        void mix_compressed_sound(audio_buffer& sound,
+                                  Uint8* stream,
+                                  const std::size_t len);
+        void init_audio();
+        void init_key_tables();
+        void advance_null_audio_device();
+        void set_swap_interval();
+        void count_draw_call(const opengl_shader_program& program,
+                             i_index_buffer* ebo);
 
         std::unique_ptr<SDL_Window, void (*)(SDL_Window*)>
             m_window { nullptr, nullptr };
@@ -348,11 +408,41 @@ namespace arci
 
         opengl_shader_program m_textured_triangle_program {};
         opengl_shader_program m_tex_no_math_program {};
+        opengl_gpu_timer m_gpu_timer {};
 
         // Desired audio spec for all sounds.
         std::vector<audio_buffer*> m_sounds {};
         SDL_AudioSpec m_desired_audio_spec {};
         SDL_AudioDeviceID m_audio_device_id {};
+        // Decoded ADPCM samples converted to the device format before
+        // mixing. Holds one block at most.
+        std::vector<Uint8> m_mix_buffer {};
+
+        engine_options m_options {};
+
+        // Lookup tables built once from the `keys` bind table, so neither
+        // events nor key queries have to search it.
+        static constexpr std::int8_t no_bind { -1 };
+        std::array<std::int8_t, SDL_NUM_SCANCODES> m_scancode_to_bind {};
+        std::array<SDL_Scancode, input_snapshot::keys_number>
+            m_key_to_scancode {};
+        input_snapshot m_input {};
+
+        // SDL events taken from the queue by one SDL_PeepEvents() call.
+        std::array<SDL_Event, 64> m_event_batch {};
+
+        // Null audio device for headless mode: the mixer output goes here
+        // and `m_null_audio_time` keeps the simulated time not mixed yet.
+        std::vector<Uint8> m_null_audio_stream {};
+        double m_null_audio_time {};
+
+        // Statistics of the frame being built and of the last finished
+        // one. The audio thread reports through the atomics.
+        engine_stats m_frame_stats {};
+        engine_stats m_stats {};
+        const opengl_shader_program* m_last_program { nullptr };
+        std::atomic<std::uint32_t> m_audio_voices {};
+        std::atomic<std::uint64_t> m_mixer_time_ns {};
 
         std::size_t m_screen_width {};
         std::size_t m_screen_height {};
@@ -362,6 +452,8 @@ namespace arci
 
     void opengl_texture::load(const std::string_view path)
     {
+        ARCI_PROFILE_SCOPE("opengl_texture::load");
+
         std::vector<unsigned char> raw_png_image {};
 
         std::ifstream file { path.data(), std::ios::binary };
@@ -434,6 +526,21 @@ namespace arci
 
     audio_buffer::audio_buffer(const std::string_view audio_file_name,
                                const SDL_AudioSpec& desired_audio_spec)
+    {
+        const std::filesystem::path fs_path { audio_file_name.data() };
+
+        if (fs_path.extension() == ".adpcm")
+        {
+            load_adpcm(audio_file_name, desired_audio_spec);
+        }
+        else
+        {
+            load_wav(audio_file_name, desired_audio_spec);
+        }
+    }
+
+    void audio_buffer::load_wav(const std::string_view audio_file_name,
+                                const SDL_AudioSpec& desired_audio_spec)
     {
         SDL_RWops* rwop_ptr_file = SDL_RWFromFile(audio_file_name.data(),
                                                   "rb");
@@ -450,6 +557,95 @@ namespace arci
 
         CHECK(music_spec);
 
+        convert(audio_spec, desired_audio_spec);
+    }
+
+    void audio_buffer::load_adpcm(const std::string_view audio_file_name,
+                                  const SDL_AudioSpec& desired_audio_spec)
+    {
+        std::ifstream file { audio_file_name.data(), std::ios::binary };
+
+        std::ostringstream error_on_opening {};
+        error_on_opening << "Error on opening sound for path "
+                         << audio_file_name << "\n";
+        if (!file.is_open())
+        {
+            print_ostream_msg_and_exit(error_on_opening);
+        }
+
+        const std::size_t bytes_to_read {
+            std::filesystem::file_size(audio_file_name.data())
+        };
+
+        compressed.resize(bytes_to_read);
+        file.read(reinterpret_cast<char*>(compressed.data()), bytes_to_read);
+        CHECK(file.good());
+
+        CHECK(adpcm::parse_header(compressed.data(),
+                                  compressed.size(),
+                                  compressed_header));
+        CHECK(compressed_header.channels <= 2);
+
+        const std::size_t pcm_bytes = std::size_t { compressed_header.frames }
+            * compressed_header.channels
+            * sizeof(std::int16_t);
+
+        // The mixer can only resample PCM, so a stream converted for another
+        // sample rate is unpacked once on load.
+        if (static_cast<int>(compressed_header.sample_rate)
+            != desired_audio_spec.freq)
+        {
+            const std::uint8_t* blocks = compressed.data()
+                + sizeof(adpcm::header);
+            std::vector<std::int16_t> pcm(std::size_t { compressed_header.blocks }
+                                          * adpcm::block_frames
+                                          * compressed_header.channels);
+
+            for (std::size_t i = 0; i < compressed_header.blocks; ++i)
+            {
+                adpcm::decode_block(compressed_header,
+                                    blocks,
+                                    i,
+                                    pcm.data()
+                                        + i * adpcm::block_frames
+                                            * compressed_header.channels);
+            }
+
+            buffer = static_cast<Uint8*>(SDL_malloc(pcm_bytes));
+            CHECK_NOTNULL(buffer);
+            std::memcpy(buffer, pcm.data(), pcm_bytes);
+            size = static_cast<Uint32>(pcm_bytes);
+
+            SDL_AudioSpec audio_spec {};
+            audio_spec.freq = static_cast<int>(compressed_header.sample_rate);
+            audio_spec.format = AUDIO_S16LSB;
+            audio_spec.channels = static_cast<Uint8>(compressed_header.channels);
+            convert(audio_spec, desired_audio_spec);
+
+            compressed.clear();
+            compressed.shrink_to_fit();
+
+            fmt::print("Sound '{}' has {} Hz instead of {} Hz, "
+                       "it's unpacked to {} KiB of PCM\n",
+                       audio_file_name,
+                       compressed_header.sample_rate,
+                       desired_audio_spec.freq,
+                       size / 1024);
+            return;
+        }
+
+        decoded_block.resize(adpcm::block_frames * compressed_header.channels);
+
+        fmt::print("Sound '{}': {} KiB of IMA-ADPCM in memory "
+                   "instead of {} KiB of PCM\n",
+                   audio_file_name,
+                   compressed.size() / 1024,
+                   pcm_bytes / 1024);
+    }
+
+    void audio_buffer::convert(const SDL_AudioSpec& audio_spec,
+                               const SDL_AudioSpec& desired_audio_spec)
+    {
         if (audio_spec.freq != desired_audio_spec.freq
             || audio_spec.channels != desired_audio_spec.channels
             || audio_spec.format != desired_audio_spec.format)
@@ -476,10 +672,22 @@ namespace arci
         }
     }
 
-    void engine_using_sdl::init()
+    void engine_using_sdl::init(const engine_options& options)
     {
-        // SDL initialization.
-        CHECK(SDL_Init(SDL_INIT_EVERYTHING) == 0);
+        m_options = options;
+
+        // SDL initialization. Headless mode doesn't touch the audio
+        // subsystem at all and renders to an offscreen EGL surface.
+        if (m_options.headless)
+        {
+            SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+            CHECK(SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS | SDL_INIT_TIMER)
+                  == 0);
+        }
+        else
+        {
+            CHECK(SDL_Init(SDL_INIT_EVERYTHING) == 0);
+        }
 
         CHECK(SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS,
                                   SDL_GL_CONTEXT_DEBUG_FLAG)
@@ -489,7 +697,8 @@ namespace arci
                                   SDL_GL_CONTEXT_PROFILE_CORE)
               == 0);
 
-        int opengl_major_version { 3 }, opengl_minor_version { 2 };
+        int opengl_major_version { m_options.gl_major_version };
+        int opengl_minor_version { m_options.gl_minor_version };
 
         CHECK(SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION,
                                   opengl_major_version)
@@ -507,27 +716,34 @@ namespace arci
                                   &opengl_minor_version)
               == 0);
 
-        CHECK(opengl_major_version == 3);
-        CHECK(opengl_minor_version == 2);
+        CHECK(opengl_major_version == m_options.gl_major_version);
+        CHECK(opengl_minor_version == m_options.gl_minor_version);
 
-        m_screen_width = 1024u;
-        m_screen_height = 768u;
+        m_screen_width = m_options.window_width;
+        m_screen_height = m_options.window_height;
 
         // Window setup.
+        const Uint32 window_flags = m_options.headless
+            ? SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN
+            : SDL_WINDOW_OPENGL;
+
         m_window = std::unique_ptr<SDL_Window, void (*)(SDL_Window*)>(
             SDL_CreateWindow(
                 "Arcanoid",
                 m_screen_width,
                 m_screen_height,
-                SDL_WINDOW_OPENGL),
+                window_flags),
             SDL_DestroyWindow);
 
         CHECK_NOTNULL(m_window.get());
 
-        CHECK(SDL_SetWindowPosition(m_window.get(),
-                                    SDL_WINDOWPOS_CENTERED,
-                                    SDL_WINDOWPOS_CENTERED)
-              == 0);
+        if (!m_options.headless)
+        {
+            CHECK(SDL_SetWindowPosition(m_window.get(),
+                                        SDL_WINDOWPOS_CENTERED,
+                                        SDL_WINDOWPOS_CENTERED)
+                  == 0);
+        }
 
         m_opengl_context = std::unique_ptr<void, int (*)(SDL_GLContext)>(
             SDL_GL_CreateContext(m_window.get()),
@@ -543,16 +759,9 @@ namespace arci
 
         CHECK(gladLoadGLES2Loader(load_opengl_func_pointer));
 
-        glEnable(GL_DEBUG_OUTPUT);
-        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
-        glDebugMessageCallback(opengl_message_callback, nullptr);
-        glDebugMessageControl(
-            GL_DONT_CARE,
-            GL_DONT_CARE,
-            GL_DONT_CARE,
-            0,
-            nullptr,
-            GL_TRUE);
+        set_swap_interval();
+
+        gl_validation::init(m_options.gl_validation);
 
         m_textured_triangle_program.load_shader(GL_VERTEX_SHADER,
                                                 "texture.vert");
@@ -586,10 +795,36 @@ namespace arci
         glViewport(0, 0, m_screen_width, m_screen_height);
         opengl_check();
 
+        m_gpu_timer.init();
+
         ImGui_ImplSdlGL3_Init(m_window.get());
 
+        init_key_tables();
+        init_audio();
+    }
+
+    void engine_using_sdl::init_key_tables()
+    {
+        m_scancode_to_bind.fill(no_bind);
+        m_key_to_scancode.fill(SDL_SCANCODE_UNKNOWN);
+
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            const SDL_Scancode scancode
+                = SDL_GetScancodeFromKey(keys[i].key_code);
+            CHECK(scancode > SDL_SCANCODE_UNKNOWN
+                  && scancode < SDL_NUM_SCANCODES);
+
+            m_scancode_to_bind[scancode] = static_cast<std::int8_t>(i);
+            m_key_to_scancode[static_cast<std::size_t>(keys[i].key)]
+                = scancode;
+        }
+    }
+
+    void engine_using_sdl::init_audio()
+    {
         SDL_memset(&m_desired_audio_spec, 0, sizeof(m_desired_audio_spec));
-        m_desired_audio_spec.freq = 48000;
+        m_desired_audio_spec.freq = m_options.audio_sample_rate;
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
         m_desired_audio_spec.format = AUDIO_F32LSB;
         m_desired_audio_spec.channels = 2;
@@ -597,10 +832,26 @@ namespace arci
         m_desired_audio_spec.format = AUDIO_S16LSB;
         m_desired_audio_spec.channels = 1;
 #endif
-        m_desired_audio_spec.samples = 4096;
+        m_desired_audio_spec.samples = m_options.audio_buffer_samples;
         m_desired_audio_spec.callback = sdl_audio_callback;
         m_desired_audio_spec.userdata = this;
 
+        m_mix_buffer.resize(adpcm::block_frames
+                            * m_desired_audio_spec.channels
+                            * sizeof(float));
+
+        if (m_options.headless)
+        {
+            const std::size_t sample_bytes
+                = m_desired_audio_spec.format == AUDIO_F32LSB
+                ? sizeof(float)
+                : sizeof(std::int16_t);
+            m_null_audio_stream.resize(m_desired_audio_spec.samples
+                                       * m_desired_audio_spec.channels
+                                       * sample_bytes);
+            return;
+        }
+
         const char* default_audio_device { nullptr };
 
         SDL_AudioSpec returned_from_open_audio_device {};
@@ -634,6 +885,7 @@ namespace arci
 
         if (SDL_PollEvent(&sdl_event))
         {
+            ++m_frame_stats.events;
             ImGui_ImplSdlGL3_ProcessEvent(&sdl_event);
 
             switch (sdl_event.type)
@@ -678,30 +930,144 @@ namespace arci
         return false;
     }
 
+    std::size_t engine_using_sdl::poll_events(input_event* events,
+                                             const std::size_t capacity)
+    {
+        SDL_PumpEvents();
+
+        std::size_t written { 0 };
+
+        // Never take more SDL events than there are free records, so
+        // nothing is lost when the caller's buffer gets full.
+        while (written < capacity)
+        {
+            const int requested = static_cast<int>(
+                std::min(capacity - written, m_event_batch.size()));
+
+            const int taken = SDL_PeepEvents(m_event_batch.data(),
+                                             requested,
+                                             SDL_GETEVENT,
+                                             SDL_EVENT_FIRST,
+                                             SDL_EVENT_LAST);
+            CHECK(taken >= 0);
+            m_frame_stats.events += static_cast<std::uint32_t>(taken);
+
+            for (int i = 0; i < taken; ++i)
+            {
+                SDL_Event& sdl_event = m_event_batch[i];
+                ImGui_ImplSdlGL3_ProcessEvent(&sdl_event);
+
+                input_event& record = events[written];
+                record.key = keys::none;
+                record.x = 0.f;
+                record.y = 0.f;
+                record.timestamp = sdl_event.common.timestamp;
+
+                switch (sdl_event.type)
+                {
+                case SDL_EVENT_QUIT:
+                    record.type = input_event_type::quit;
+                    ++written;
+                    break;
+
+                case SDL_EVENT_KEY_DOWN:
+                case SDL_EVENT_KEY_UP:
+                {
+                    const std::optional<bind_key> bind
+                        = get_key_for_event(sdl_event);
+                    if (bind)
+                    {
+                        record.type = sdl_event.type == SDL_EVENT_KEY_DOWN
+                            ? input_event_type::key_pressed
+                            : input_event_type::key_released;
+                        record.key = bind->key;
+                        ++written;
+                    }
+                    break;
+                }
+
+                case SDL_EVENT_MOUSE_BUTTON_DOWN:
+                case SDL_EVENT_MOUSE_BUTTON_UP:
+                    record.type = sdl_event.type == SDL_EVENT_MOUSE_BUTTON_DOWN
+                        ? input_event_type::mouse_button_pressed
+                        : input_event_type::mouse_button_released;
+                    record.x = sdl_event.button.x;
+                    record.y = sdl_event.button.y;
+                    ++written;
+                    break;
+
+                default:
+                    break;
+                }
+            }
+
+            if (taken < requested)
+            {
+                break;
+            }
+        }
+
+        return written;
+    }
+
     bool engine_using_sdl::key_down(const enum keys key)
     {
-        const auto iter = std::find_if(
-            keys.begin(),
-            keys.end(),
-            [key](const bind_key& bind) {
-                return bind.key == key;
-            });
-
-        if (iter != keys.end())
+        return m_input.is_held(key);
+    }
+
+    void engine_using_sdl::latch_input()
+    {
+        const Uint8* state = SDL_GetKeyboardState(nullptr);
+        const std::uint64_t now = SDL_GetTicksNS();
+
+        std::bitset<input_snapshot::keys_number> held {};
+        for (std::size_t i = 0; i < input_snapshot::keys_number; ++i)
         {
-            const Uint8* state = SDL_GetKeyboardState(nullptr);
-            const SDL_Scancode sdl_scan_code
-                = SDL_GetScancodeFromKey(iter->key_code);
-            return state[sdl_scan_code];
+            const SDL_Scancode scancode = m_key_to_scancode[i];
+            held[i] = scancode != SDL_SCANCODE_UNKNOWN && state[scancode];
         }
 
-        return false;
+        const std::bitset<input_snapshot::keys_number> changed
+            = held ^ m_input.held;
+
+        m_input.pressed = changed & held;
+        m_input.released = changed & m_input.held;
+        m_input.held = held;
+        m_input.latched_at = now;
+
+        for (std::size_t i = 0; i < input_snapshot::keys_number; ++i)
+        {
+            if (changed[i])
+            {
+                m_input.changed_at[i] = now;
+            }
+        }
+    }
+
+    bool engine_using_sdl::wait_events(const std::uint32_t timeout_ms)
+    {
+        if (m_options.headless)
+        {
+            return true;
+        }
+
+        ARCI_PROFILE_SCOPE("engine::wait_events");
+
+        // Without an event argument SDL only waits and keeps the queue.
+        return SDL_WaitEventTimeout(nullptr, static_cast<Sint32>(timeout_ms))
+            != 0;
+    }
+
+    const input_snapshot& engine_using_sdl::get_input() const noexcept
+    {
+        return m_input;
     }
 
     itexture* engine_using_sdl::create_texture(const std::string_view path)
     {
         itexture* texture = new opengl_texture {};
         texture->load(path);
+        ++m_frame_stats.textures_created;
         return texture;
     }
 
@@ -714,12 +1080,17 @@ namespace arci
     ivertex_buffer* engine_using_sdl::create_vertex_buffer(
         const std::vector<triangle>& triangles)
     {
+        ++m_frame_stats.buffers_created;
+        m_frame_stats.vertex_bytes_uploaded
+            += triangles.size() * 3 * sizeof(vertex);
         return new vertex_buffer { triangles };
     }
 
     ivertex_buffer* engine_using_sdl::create_vertex_buffer(
         const std::vector<vertex>& vertices)
     {
+        ++m_frame_stats.buffers_created;
+        m_frame_stats.vertex_bytes_uploaded += vertices.size() * sizeof(vertex);
         return new vertex_buffer { vertices };
     }
 
@@ -731,6 +1102,8 @@ namespace arci
 
     i_index_buffer* engine_using_sdl::create_ebo(const std::vector<uint32_t>& indices)
     {
+        ++m_frame_stats.buffers_created;
+        m_frame_stats.index_bytes_uploaded += indices.size() * sizeof(uint32_t);
         return new index_buffer { indices };
     }
 
@@ -768,19 +1141,60 @@ namespace arci
 
     void engine_using_sdl::imgui_render()
     {
+        ARCI_PROFILE_SCOPE("engine::imgui_render");
+
         ImGui::Render();
+
+        m_gpu_timer.begin_pass("gpu/imgui");
         ImGui_ImplSdlGL3_RenderDrawLists(ImGui::GetDrawData());
+        m_gpu_timer.end_pass();
+
+        // ImGui binds its own program, so the next draw is a switch.
+        m_last_program = nullptr;
+    }
+
+    const engine_stats& engine_using_sdl::get_stats() const noexcept
+    {
+        return m_stats;
+    }
+
+    void engine_using_sdl::count_draw_call(const opengl_shader_program& program,
+                                           i_index_buffer* ebo)
+    {
+        ++m_frame_stats.draw_calls;
+        m_frame_stats.triangles += ebo->get_indices_number() / 3;
+
+        if (m_last_program != &program)
+        {
+            ++m_frame_stats.shader_switches;
+            m_last_program = &program;
+        }
+    }
+
+    void engine_using_sdl::begin_gpu_pass(const char* name)
+    {
+        m_gpu_timer.begin_pass(name);
+    }
+
+    void engine_using_sdl::end_gpu_pass()
+    {
+        m_gpu_timer.end_pass();
     }
 
     void engine_using_sdl::render(ivertex_buffer* vertex_buffer,
                                   i_index_buffer* ebo,
                                   itexture* const texture)
     {
+        ARCI_PROFILE_SCOPE("engine::render");
+
+        count_draw_call(m_tex_no_math_program, ebo);
+
         m_tex_no_math_program.apply_shader_program();
 
         m_tex_no_math_program.set_uniform("s_texture");
 
         texture->bind();
+        ++m_frame_stats.texture_binds;
         vertex_buffer->bind();
         ebo->bind();
 
@@ -839,12 +1253,17 @@ namespace arci
                                   itexture* const texture,
                                   const glm::mediump_mat3& matrix)
     {
+        ARCI_PROFILE_SCOPE("engine::render");
+
+        count_draw_call(m_textured_triangle_program, ebo);
+
         m_textured_triangle_program.apply_shader_program();
 
         m_textured_triangle_program.set_uniform("u_matrix", matrix);
         m_textured_triangle_program.set_uniform("s_texture");
 
         texture->bind();
+        ++m_frame_stats.texture_binds;
         vertex_buffer->bind();
         ebo->bind();
 
@@ -900,8 +1319,31 @@ namespace arci
 
     void engine_using_sdl::swap_buffers()
     {
+        ARCI_PROFILE_SCOPE("engine::swap_buffers");
+
+        m_frame_stats.audio_voices = m_audio_voices.load();
+        m_frame_stats.mixer_time_ns = m_mixer_time_ns.exchange(0);
+        m_stats = m_frame_stats;
+        m_frame_stats = engine_stats {};
+        m_last_program = nullptr;
+
+        ARCI_PROFILE_COUNTER("draw_calls", m_stats.draw_calls);
+        ARCI_PROFILE_COUNTER("triangles", m_stats.triangles);
+        ARCI_PROFILE_COUNTER("upload_bytes",
+                             m_stats.vertex_bytes_uploaded
+                                 + m_stats.index_bytes_uploaded);
+        ARCI_PROFILE_COUNTER("voices", m_stats.audio_voices);
+
+        m_gpu_timer.end_frame();
+        gl_validation::end_frame();
+
         CHECK(!SDL_GL_SwapWindow(m_window.get()));
 
+        if (m_options.headless)
+        {
+            advance_null_audio_device();
+        }
+
         glClearColor(0.f, 1.f, 1.f, 1.f);
         opengl_check();
         glClear(GL_COLOR_BUFFER_BIT);
@@ -910,11 +1352,62 @@ namespace arci
 
     void engine_using_sdl::uninit()
     {
-        CHECK(SDL_PauseAudioDevice(m_audio_device_id) == 0);
-        SDL_CloseAudioDevice(m_audio_device_id);
+        m_gpu_timer.uninit();
+
+        if (!m_options.headless)
+        {
+            CHECK(SDL_PauseAudioDevice(m_audio_device_id) == 0);
+            SDL_CloseAudioDevice(m_audio_device_id);
+        }
         SDL_Quit();
     }
 
+    void engine_using_sdl::advance_null_audio_device()
+    {
+        // Mix exactly as much audio as a real device would have consumed
+        // during one simulated frame, in chunks of the device buffer size.
+        m_null_audio_time += m_options.simulated_frame_time;
+
+        const std::size_t frame_bytes = m_null_audio_stream.size()
+            / m_desired_audio_spec.samples;
+        std::size_t frames_to_mix = static_cast<std::size_t>(
+            m_null_audio_time * m_desired_audio_spec.freq);
+        m_null_audio_time -= static_cast<double>(frames_to_mix)
+            / m_desired_audio_spec.freq;
+
+        while (frames_to_mix > 0)
+        {
+            const std::size_t frames = std::min<std::size_t>(
+                frames_to_mix,
+                m_desired_audio_spec.samples);
+            sdl_audio_callback(this,
+                               m_null_audio_stream.data(),
+                               static_cast<int>(frames * frame_bytes));
+            frames_to_mix -= frames;
+        }
+    }
+
+    void engine_using_sdl::set_swap_interval()
+    {
+        // Nobody looks at the headless frames, so don't wait for vsync.
+        if (m_options.headless || m_options.vsync == vsync_mode::off)
+        {
+            SDL_GL_SetSwapInterval(0);
+            return;
+        }
+
+        if (m_options.vsync == vsync_mode::adaptive
+            && SDL_GL_SetSwapInterval(-1) == 0)
+        {
+            return;
+        }
+
+        if (SDL_GL_SetSwapInterval(1) != 0)
+        {
+            fmt::print("Vsync isn't available: {}\n", SDL_GetError());
+        }
+    }
+
     void engine_using_sdl::imgui_uninit()
     {
         ImGui_ImplSdlGL3_Shutdown();
@@ -934,38 +1427,57 @@ namespace arci
     std::optional<bind_key> engine_using_sdl::get_key_for_event(
         const SDL_Event& sdl_event)
     {
-        const auto iter = std::find_if(
-            keys.begin(),
-            keys.end(),
-            [&sdl_event](const bind_key& k) {
-                return sdl_event.key.keysym.sym == k.key_code;
-            });
-
-        if (iter != keys.end())
+        const SDL_Scancode scancode = sdl_event.key.keysym.scancode;
+
+        if (scancode < 0 || scancode >= SDL_NUM_SCANCODES
+            || m_scancode_to_bind[scancode] == no_bind)
         {
-            return std::make_optional(*iter);
+            return {};
         }
 
-        return {};
+        return keys[m_scancode_to_bind[scancode]];
     }
 
     void engine_using_sdl::sdl_audio_callback(void* userdata, Uint8* stream, int len)
     {
+        ARCI_PROFILE_SCOPE("engine::audio_callback");
+
         std::lock_guard<std::mutex> lock { audio_mutex };
 
         std::memset(stream, 0, len);
 
         engine_using_sdl* engine = static_cast<engine_using_sdl*>(userdata);
 
+        // The null audio device calls back from the main thread.
+        if (!engine->m_options.headless)
+        {
+            ARCI_PROFILE_THREAD("audio");
+        }
+
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32) && !defined(__CYGWIN__)
         constexpr int32_t AUDIO_FORMAT = AUDIO_F32LSB;
 #else
         constexpr int32_t AUDIO_FORMAT = AUDIO_S16LSB;
 #endif
 
+        const auto mix_start = std::chrono::steady_clock::now();
+
+        engine->m_audio_voices.store(static_cast<std::uint32_t>(
+            std::count_if(engine->m_sounds.begin(),
+                          engine->m_sounds.end(),
+                          [](const audio_buffer* sound) {
+                              return sound->is_running;
+                          })));
+
         for (audio_buffer* sound : engine->m_sounds)
         {
-            if (sound->is_running)
+            if (sound->is_running && sound->is_compressed())
+            {
+                engine->mix_compressed_sound(*sound,
+                                             stream,
+                                             static_cast<std::size_t>(len));
+            }
+            else if (sound->is_running)
             {
                 std::size_t stream_len { static_cast<std::size_t>(len) };
 
@@ -1009,6 +1521,100 @@ namespace arci
                 }
             }
         }
+
+        engine->m_mixer_time_ns.fetch_add(static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - mix_start)
+                .count()));
+    }
+
+    void engine_using_sdl::mix_compressed_sound(audio_buffer& sound,
+                                                Uint8* stream,
+                                                const std::size_t len)
+    {
+        const std::size_t channels = m_desired_audio_spec.channels;
+        const std::size_t sound_channels = sound.compressed_header.channels;
+        const bool is_float = m_desired_audio_spec.format == AUDIO_F32LSB;
+        const std::size_t frame_bytes = channels
+            * (is_float ? sizeof(float) : sizeof(std::int16_t));
+        const std::uint8_t* blocks = sound.compressed.data()
+            + sizeof(adpcm::header);
+
+        std::size_t offset {};
+
+        while (offset + frame_bytes <= len)
+        {
+            if (sound.current_position == sound.decoded_frames)
+            {
+                if (sound.next_block == sound.compressed_header.blocks)
+                {
+                    if (sound.mode != audio_buffer::running_mode::for_ever)
+                    {
+                        sound.is_running = false;
+                        return;
+                    }
+
+                    sound.next_block = 0;
+                }
+
+                sound.decoded_frames = adpcm::decode_block(
+                    sound.compressed_header,
+                    blocks,
+                    sound.next_block++,
+                    sound.decoded_block.data());
+                sound.current_position = 0;
+            }
+
+            const std::size_t frames = std::min(
+                sound.decoded_frames - sound.current_position,
+                (len - offset) / frame_bytes);
+            const std::int16_t* samples = sound.decoded_block.data()
+                + sound.current_position * sound_channels;
+
+            // Expand to the device layout: mono is duplicated to every
+            // channel, stereo is downmixed for a mono device.
+            for (std::size_t frame = 0; frame < frames; ++frame)
+            {
+                for (std::size_t channel = 0; channel < channels; ++channel)
+                {
+                    const std::int32_t sample = sound_channels == channels
+                        ? samples[frame * sound_channels + channel]
+                        : sound_channels == 1
+                        ? samples[frame]
+                        : (samples[frame * 2] + samples[frame * 2 + 1]) / 2;
+
+                    const std::size_t index = frame * channels + channel;
+
+                    if (is_float)
+                    {
+                        reinterpret_cast<float*>(m_mix_buffer.data())[index]
+                            = sample / 32768.f;
+                    }
+                    else
+                    {
+                        reinterpret_cast<std::int16_t*>(
+                            m_mix_buffer.data())[index]
+                            = static_cast<std::int16_t>(sample);
+                    }
+                }
+            }
+
+            SDL_MixAudioFormat(stream + offset,
+                               m_mix_buffer.data(),
+                               m_desired_audio_spec.format,
+                               static_cast<Uint32>(frames * frame_bytes),
+                               SDL_MIX_MAXVOLUME);
+
+            offset += frames * frame_bytes;
+            sound.current_position += frames;
+        }
+
+        if (sound.mode == audio_buffer::running_mode::once
+            && sound.next_block == sound.compressed_header.blocks
+            && sound.current_position == sound.decoded_frames)
+        {
+            sound.is_running = false;
+        }
     }
 
     ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,332 @@
+#include "opengl-debug.hxx"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci::gl_validation
+{
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    static constexpr std::size_t trace_capacity { 256 };
+    static constexpr std::size_t trace_entry_size { 128 };
+
+    // One traced call as text, e.g. "glBindBuffer(0x8892, 0x3)".
+    struct trace_entry
+    {
+        std::array<char, trace_entry_size> text {};
+    };
+
+    static std::array<trace_entry, trace_capacity> trace_ring {};
+    static std::uint64_t trace_position {};
+    static gl_validation_mode current_mode { gl_validation_mode::off };
+    static std::uint64_t frame {};
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    template<typename T>
+    static void format_argument(fmt::memory_buffer& buffer, const T value)
+    {
+        auto out = std::back_inserter(buffer);
+
+        if constexpr (std::is_pointer_v<T>)
+        {
+            fmt::format_to(out, "{}", reinterpret_cast<const void*>(value));
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            fmt::format_to(out, "{}", value);
+        }
+        else if constexpr (std::is_same_v<T, GLboolean>)
+        {
+            fmt::format_to(out, "{}", value ? "GL_TRUE" : "GL_FALSE");
+        }
+        else if constexpr (std::is_unsigned_v<T>)
+        {
+            // Enums, bit fields and object names.
+            fmt::format_to(out, "{:#x}", value);
+        }
+        else
+        {
+            fmt::format_to(out, "{}", value);
+        }
+    }
+
+    template<typename... Args>
+    static void record_call(const char* name, const Args... args)
+    {
+        fmt::memory_buffer buffer {};
+        fmt::format_to(std::back_inserter(buffer), "{}(", name);
+
+        bool first { true };
+        [[maybe_unused]] auto append = [&buffer, &first](const auto value) {
+            if (!first)
+            {
+                constexpr std::string_view separator { ", " };
+                buffer.append(separator.data(),
+                              separator.data() + separator.size());
+            }
+            first = false;
+            format_argument(buffer, value);
+        };
+        (append(args), ...);
+        buffer.push_back(')');
+
+        trace_entry& entry = trace_ring[trace_position++ % trace_capacity];
+        const std::size_t size = std::min(buffer.size(),
+                                          entry.text.size() - 1);
+        std::copy_n(buffer.data(), size, entry.text.data());
+        entry.text[size] = '\0';
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    // Glad keeps every GL entry point in a global function pointer. In the
+    // `trace` mode the pointers are replaced with these wrappers, which
+    // log the call and forward it to the original function.
+    template<auto* Pointer>
+    struct traced_function
+    {
+        static inline std::remove_pointer_t<decltype(Pointer)> original {};
+        static inline const char* name {};
+    };
+
+    template<auto* Pointer, typename Ret, typename... Args>
+    static Ret APIENTRY traced_call(Args... args)
+    {
+        record_call(traced_function<Pointer>::name, args...);
+        return traced_function<Pointer>::original(args...);
+    }
+
+    template<auto* Pointer, typename Ret, typename... Args>
+    static void install(Ret(APIENTRYP)(Args...), const char* name)
+    {
+        if (*Pointer == nullptr)
+        {
+            return;
+        }
+
+        traced_function<Pointer>::original = *Pointer;
+        traced_function<Pointer>::name = name;
+        *Pointer = &traced_call<Pointer, Ret, Args...>;
+    }
+
+#ifdef ARCI_GL_VALIDATION
+#define ARCI_GL_TRACE_FUNCTION(function)                                      \
+    install<&glad_##function>(glad_##function, #function)
+
+    // Every GL function used by the engine and the ImGui backend.
+    static void install_trace()
+    {
+        ARCI_GL_TRACE_FUNCTION(glActiveTexture);
+        ARCI_GL_TRACE_FUNCTION(glAttachShader);
+        ARCI_GL_TRACE_FUNCTION(glBeginQuery);
+        ARCI_GL_TRACE_FUNCTION(glBindBuffer);
+        ARCI_GL_TRACE_FUNCTION(glBindSampler);
+        ARCI_GL_TRACE_FUNCTION(glBindTexture);
+        ARCI_GL_TRACE_FUNCTION(glBindVertexArray);
+        ARCI_GL_TRACE_FUNCTION(glBlendEquation);
+        ARCI_GL_TRACE_FUNCTION(glBlendEquationSeparate);
+        ARCI_GL_TRACE_FUNCTION(glBlendFunc);
+        ARCI_GL_TRACE_FUNCTION(glBlendFuncSeparate);
+        ARCI_GL_TRACE_FUNCTION(glBufferData);
+        ARCI_GL_TRACE_FUNCTION(glClear);
+        ARCI_GL_TRACE_FUNCTION(glClearColor);
+        ARCI_GL_TRACE_FUNCTION(glCompileShader);
+        ARCI_GL_TRACE_FUNCTION(glCreateProgram);
+        ARCI_GL_TRACE_FUNCTION(glCreateShader);
+        ARCI_GL_TRACE_FUNCTION(glDeleteBuffers);
+        ARCI_GL_TRACE_FUNCTION(glDeleteProgram);
+        ARCI_GL_TRACE_FUNCTION(glDeleteQueries);
+        ARCI_GL_TRACE_FUNCTION(glDeleteShader);
+        ARCI_GL_TRACE_FUNCTION(glDeleteTextures);
+        ARCI_GL_TRACE_FUNCTION(glDeleteVertexArrays);
+        ARCI_GL_TRACE_FUNCTION(glDetachShader);
+        ARCI_GL_TRACE_FUNCTION(glDisable);
+        ARCI_GL_TRACE_FUNCTION(glDisableVertexAttribArray);
+        ARCI_GL_TRACE_FUNCTION(glDrawElements);
+        ARCI_GL_TRACE_FUNCTION(glEnable);
+        ARCI_GL_TRACE_FUNCTION(glEnableVertexAttribArray);
+        ARCI_GL_TRACE_FUNCTION(glEndQuery);
+        ARCI_GL_TRACE_FUNCTION(glGenBuffers);
+        ARCI_GL_TRACE_FUNCTION(glGenQueries);
+        ARCI_GL_TRACE_FUNCTION(glGenTextures);
+        ARCI_GL_TRACE_FUNCTION(glGenVertexArrays);
+        ARCI_GL_TRACE_FUNCTION(glGenerateMipmap);
+        ARCI_GL_TRACE_FUNCTION(glGetAttribLocation);
+        ARCI_GL_TRACE_FUNCTION(glGetIntegerv);
+        ARCI_GL_TRACE_FUNCTION(glGetProgramInfoLog);
+        ARCI_GL_TRACE_FUNCTION(glGetProgramiv);
+        ARCI_GL_TRACE_FUNCTION(glGetQueryObjectuiv);
+        ARCI_GL_TRACE_FUNCTION(glGetShaderInfoLog);
+        ARCI_GL_TRACE_FUNCTION(glGetShaderiv);
+        ARCI_GL_TRACE_FUNCTION(glGetUniformLocation);
+        ARCI_GL_TRACE_FUNCTION(glIsEnabled);
+        ARCI_GL_TRACE_FUNCTION(glLinkProgram);
+        ARCI_GL_TRACE_FUNCTION(glPixelStorei);
+        ARCI_GL_TRACE_FUNCTION(glScissor);
+        ARCI_GL_TRACE_FUNCTION(glShaderSource);
+        ARCI_GL_TRACE_FUNCTION(glTexImage2D);
+        ARCI_GL_TRACE_FUNCTION(glTexParameteri);
+        ARCI_GL_TRACE_FUNCTION(glUniform1i);
+        ARCI_GL_TRACE_FUNCTION(glUniformMatrix3fv);
+        ARCI_GL_TRACE_FUNCTION(glUniformMatrix4fv);
+        ARCI_GL_TRACE_FUNCTION(glUseProgram);
+        ARCI_GL_TRACE_FUNCTION(glValidateProgram);
+        ARCI_GL_TRACE_FUNCTION(glVertexAttribPointer);
+        ARCI_GL_TRACE_FUNCTION(glViewport);
+    }
+
+#undef ARCI_GL_TRACE_FUNCTION
+#endif
+
+    static void print_trace()
+    {
+        const std::uint64_t count = std::min<std::uint64_t>(trace_position,
+                                                            trace_capacity);
+
+        if (count == 0)
+        {
+            return;
+        }
+
+        fmt::print("Last {} GL calls, oldest first:\n", count);
+
+        for (std::uint64_t i = trace_position - count; i < trace_position;
+             ++i)
+        {
+            fmt::print("  {}\n", trace_ring[i % trace_capacity].text.data());
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    void init([[maybe_unused]] const gl_validation_mode mode)
+    {
+#ifdef ARCI_GL_VALIDATION
+        current_mode = mode;
+#endif
+        check_each_call = current_mode == gl_validation_mode::trace;
+
+        if (current_mode == gl_validation_mode::off)
+        {
+            return;
+        }
+
+        // Synchronous output makes the driver finish every call before
+        // returning, worth it only when each call is checked anyway.
+        glEnable(GL_DEBUG_OUTPUT);
+        if (current_mode == gl_validation_mode::trace)
+        {
+            glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        }
+        glDebugMessageCallback(opengl_message_callback, nullptr);
+        glDebugMessageControl(
+            GL_DONT_CARE,
+            GL_DONT_CARE,
+            GL_DONT_CARE,
+            0,
+            nullptr,
+            GL_TRUE);
+
+#ifdef ARCI_GL_VALIDATION
+        if (current_mode == gl_validation_mode::trace)
+        {
+            install_trace();
+        }
+#endif
+    }
+
+    gl_validation_mode get_mode() noexcept
+    {
+        return current_mode;
+    }
+
+    void end_frame()
+    {
+        ++frame;
+
+        if (current_mode != gl_validation_mode::errors)
+        {
+            return;
+        }
+
+        bool has_errors { false };
+
+        for (GLenum error = glGetError(); error != GL_NO_ERROR;
+             error = glGetError())
+        {
+            fmt::print("OpenGL error in frame {}: {}\n",
+                       frame,
+                       error_to_string(error));
+            has_errors = true;
+        }
+
+        if (has_errors)
+        {
+            fmt::print("Run with GL validation `trace` to find the call\n");
+            std::exit(1);
+        }
+    }
+
+    void check(const char* file, const int line)
+    {
+        const GLenum error = glGetError();
+
+        if (error == GL_NO_ERROR)
+        {
+            return;
+        }
+
+        fmt::print("OpenGL error: {}\n"
+                   "File: {}\n"
+                   "Line: {}\n",
+                   error_to_string(error),
+                   file,
+                   line);
+        print_trace();
+        std::exit(1);
+    }
+
+    std::string error_to_string(const GLenum error)
+    {
+        switch (error)
+        {
+        case GL_INVALID_ENUM:
+            return "An unacceptable value is specified"
+                   " for an enumerated argument";
+        case GL_INVALID_VALUE:
+            return "A numeric argument is out of range";
+        case GL_INVALID_OPERATION:
+            return "The specified operation is not"
+                   " allowed in the current state";
+        case GL_INVALID_FRAMEBUFFER_OPERATION:
+            return "The framebuffer object is not complete";
+        case GL_OUT_OF_MEMORY:
+            return "There is not enough memory left to execute"
+                   " the command";
+        case GL_STACK_UNDERFLOW:
+            return "An attempt has been made to perform"
+                   " an operation that would cause an internal"
+                   " stack to underflow";
+        case GL_STACK_OVERFLOW:
+            return "An attempt has been made to perform"
+                   " an operation that would cause an internal"
+                   " stack to overflow";
+        default:
+            return "Undefined opengl error type";
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci::gl_validation
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,170 @@
+#include "opengl-gpu-timer.hxx"
+#include "opengl-debug.hxx"
+#include "profiler.hxx"
+
+#include <SDL3/SDL.h>
+
+#include <fmt/core.h>
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci
+{
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    // Both extensions share the enum values with core GL 3.3.
+    static constexpr GLenum time_elapsed { 0x88BF };
+    static constexpr GLenum gpu_disjoint { 0x8FBB };
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    void opengl_gpu_timer::init()
+    {
+#ifdef ARCI_PROFILER
+        const bool has_arb = SDL_GL_ExtensionSupported("GL_ARB_timer_query");
+        m_is_disjoint_ext
+            = SDL_GL_ExtensionSupported("GL_EXT_disjoint_timer_query");
+        m_is_supported = has_arb || m_is_disjoint_ext;
+#endif
+
+        if (!m_is_supported)
+        {
+            fmt::print("GPU timer queries aren't available,"
+                       " GPU pass times won't be reported\n");
+            return;
+        }
+
+        for (frame_queries& frame : m_frames)
+        {
+            glGenQueries(static_cast<GLsizei>(frame.queries.size()),
+                         frame.queries.data());
+            opengl_check();
+        }
+    }
+
+    void opengl_gpu_timer::uninit()
+    {
+        if (!m_is_supported)
+        {
+            return;
+        }
+
+        for (frame_queries& frame : m_frames)
+        {
+            glDeleteQueries(static_cast<GLsizei>(frame.queries.size()),
+                            frame.queries.data());
+            opengl_check();
+            frame.passes = 0;
+        }
+
+        m_is_supported = false;
+    }
+
+    bool opengl_gpu_timer::is_supported() const noexcept
+    {
+        return m_is_supported;
+    }
+
+    void opengl_gpu_timer::begin_pass(const char* name)
+    {
+        frame_queries& frame = m_frames[m_frame_index];
+
+        if (!m_is_supported || m_in_pass || frame.passes == max_passes)
+        {
+            return;
+        }
+
+        glBeginQuery(time_elapsed, frame.queries[frame.passes]);
+        opengl_check();
+
+        frame.names[frame.passes] = name;
+        m_in_pass = true;
+    }
+
+    void opengl_gpu_timer::end_pass()
+    {
+        if (!m_in_pass)
+        {
+            return;
+        }
+
+        glEndQuery(time_elapsed);
+        opengl_check();
+
+        ++m_frames[m_frame_index].passes;
+        m_in_pass = false;
+    }
+
+    void opengl_gpu_timer::end_frame()
+    {
+        if (!m_is_supported)
+        {
+            return;
+        }
+
+        end_pass();
+
+        m_frame_index = (m_frame_index + 1) % frames_in_flight;
+
+        // The slot to be reused is the oldest frame in flight.
+        frame_queries& oldest = m_frames[m_frame_index];
+        resolve_frame(oldest);
+        oldest.passes = 0;
+    }
+
+    void opengl_gpu_timer::resolve_frame(frame_queries& frame)
+    {
+        if (frame.passes == 0)
+        {
+            return;
+        }
+
+        // Queries finish in order, so the last one tells about all.
+        GLuint available { GL_FALSE };
+        glGetQueryObjectuiv(frame.queries[frame.passes - 1],
+                            GL_QUERY_RESULT_AVAILABLE,
+                            &available);
+        opengl_check();
+
+        if (available == GL_FALSE)
+        {
+            return;
+        }
+
+        // A disjoint operation (e.g. a GPU frequency change) makes all
+        // the results in flight meaningless.
+        if (m_is_disjoint_ext)
+        {
+            GLint disjoint { 0 };
+            glGetIntegerv(gpu_disjoint, &disjoint);
+            opengl_check();
+
+            if (disjoint != 0)
+            {
+                return;
+            }
+        }
+
+        double frame_ms { 0.0 };
+
+        for (std::size_t i = 0; i < frame.passes; ++i)
+        {
+            // 32 bits of nanoseconds are enough for a single pass.
+            GLuint elapsed { 0 };
+            glGetQueryObjectuiv(frame.queries[i], GL_QUERY_RESULT, &elapsed);
+            opengl_check();
+
+            const double pass_ms = elapsed * 1e-6;
+            frame_ms += pass_ms;
+            ARCI_PROFILE_COUNTER(frame.names[i], pass_ms);
+        }
+
+        ARCI_PROFILE_COUNTER("gpu/frame", frame_ms);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,785 @@
+#include "profiler.hxx"
+
+#include <imgui.h>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace arci::profiler
+{
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    // Must be a power of two. At 60 FPS it holds several frames of a busy
+    // thread, records which don't fit are dropped and counted.
+    static constexpr std::size_t buffer_capacity { 8192 };
+    static constexpr std::size_t max_threads { 16 };
+
+    // Averages and maximums are published once per window.
+    static constexpr std::size_t stats_window { 120 };
+
+    // A frame counts as a spike for a zone when the zone took twice its
+    // average and at least this much longer.
+    static constexpr std::uint64_t spike_min_excess { 100'000 };
+
+    // Records waiting for the trace writer, ~12 MB.
+    static constexpr std::size_t max_trace_backlog { 256 * 1024 };
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    enum class record_type : std::uint8_t
+    {
+        zone,
+        counter,
+    };
+
+    // Counters travel in the same rings as zones: for them `zone.start`
+    // is the sample time and `zone.end` is unused.
+    struct record
+    {
+        zone_record zone {};
+        double value {};
+        record_type type { record_type::zone };
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    // Single producer (the owner thread) / single consumer (the thread
+    // calling end_frame()) ring of zones.
+    struct thread_buffer
+    {
+        std::array<record, buffer_capacity> records {};
+        std::atomic<std::uint64_t> head {};
+        std::atomic<std::uint64_t> tail {};
+        std::atomic<std::uint64_t> dropped {};
+        std::atomic<const char*> name { "thread" };
+
+        // Touched by the owner thread only.
+        std::uint32_t depth {};
+        std::uint32_t index {};
+    };
+
+    struct zone_stats
+    {
+        const char* name {};
+        std::uint32_t thread {};
+        std::uint64_t frame_total {};
+        std::uint64_t window_total {};
+        std::uint64_t window_max {};
+        std::uint64_t average {};
+        std::uint64_t max {};
+        std::uint64_t spikes {};
+    };
+
+    struct counter_value
+    {
+        const char* name {};
+        double value {};
+    };
+
+    // Owned by the writer thread between start_trace() and stop_trace().
+    struct trace_writer
+    {
+        std::FILE* file { nullptr };
+        fmt::memory_buffer text {};
+        std::vector<record> records {};
+        bool first_event { true };
+    };
+
+    struct profiler_state
+    {
+        const std::chrono::steady_clock::time_point origin {
+            std::chrono::steady_clock::now()
+        };
+
+        std::mutex registry_mutex {};
+        std::array<std::unique_ptr<thread_buffer>, max_threads> threads {};
+        std::atomic<std::uint32_t> threads_number {};
+
+        // Below is owned by the thread calling end_frame().
+        std::vector<zone_record> collecting {};
+        std::vector<zone_record> frame_zones {};
+        std::vector<zone_stats> zones {};
+        std::vector<counter_value> counters {};
+        std::vector<record> trace_chunk {};
+        std::uint64_t collecting_start {};
+        std::uint64_t frame_start {};
+        std::uint64_t frame_end {};
+        std::size_t window_frames {};
+        bool paused { false };
+
+        // Hand-off to the trace writer.
+        std::mutex trace_mutex {};
+        std::condition_variable trace_condition {};
+        std::vector<record> trace_backlog {};
+        bool trace_stop { false };
+        std::uint64_t trace_dropped {};
+        std::atomic<bool> tracing { false };
+        std::thread trace_thread {};
+        trace_writer writer {};
+    };
+
+    static profiler_state& get_state()
+    {
+        static profiler_state state {};
+        return state;
+    }
+
+    static thread_local thread_buffer* current_thread_buffer { nullptr };
+
+    // Returns nullptr when the registry is full: zones of such threads
+    // are not recorded.
+    static thread_buffer* get_thread_buffer()
+    {
+        if (current_thread_buffer != nullptr)
+        {
+            return current_thread_buffer;
+        }
+
+        profiler_state& state = get_state();
+        std::lock_guard<std::mutex> lock { state.registry_mutex };
+
+        const std::uint32_t index = state.threads_number.load();
+        if (index == max_threads)
+        {
+            return nullptr;
+        }
+
+        // Buffers are never freed: a thread may finish while its zones
+        // are still waiting in the ring.
+        state.threads[index] = std::make_unique<thread_buffer>();
+        state.threads[index]->index = index;
+        current_thread_buffer = state.threads[index].get();
+        state.threads_number.store(index + 1, std::memory_order_release);
+
+        return current_thread_buffer;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    static void push_record(thread_buffer& buffer, const record& value)
+    {
+        const std::uint64_t head
+            = buffer.head.load(std::memory_order_relaxed);
+        const std::uint64_t tail
+            = buffer.tail.load(std::memory_order_acquire);
+
+        if (head - tail == buffer_capacity)
+        {
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        buffer.records[head & (buffer_capacity - 1)] = value;
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    std::uint64_t now() noexcept
+    {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - get_state().origin)
+                .count());
+    }
+
+    void set_thread_name(const char* name) noexcept
+    {
+        thread_buffer* buffer = get_thread_buffer();
+
+        if (buffer != nullptr)
+        {
+            buffer->name.store(name, std::memory_order_relaxed);
+        }
+    }
+
+    void add_counter(const char* name, const double value) noexcept
+    {
+        thread_buffer* buffer = get_thread_buffer();
+
+        if (buffer != nullptr)
+        {
+            push_record(*buffer,
+                        record {
+                            zone_record {
+                                name,
+                                now(),
+                                0,
+                                0,
+                                buffer->index,
+                            },
+                            value,
+                            record_type::counter,
+                        });
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    scope::scope(const char* name) noexcept
+        : m_name { name }
+    {
+        thread_buffer* buffer = get_thread_buffer();
+
+        if (buffer != nullptr)
+        {
+            ++buffer->depth;
+        }
+
+        m_start = now();
+    }
+
+    scope::~scope()
+    {
+        const std::uint64_t end = now();
+        thread_buffer* buffer = current_thread_buffer;
+
+        if (buffer == nullptr)
+        {
+            return;
+        }
+
+        --buffer->depth;
+
+        push_record(*buffer,
+                    record {
+                        zone_record {
+                            m_name,
+                            m_start,
+                            end,
+                            buffer->depth,
+                            buffer->index,
+                        },
+                        0.0,
+                        record_type::zone,
+                    });
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    [[maybe_unused]] static zone_stats& get_zone_stats(
+        profiler_state& state,
+        const zone_record& record)
+    {
+        for (zone_stats& zone : state.zones)
+        {
+            if (zone.name == record.name && zone.thread == record.thread)
+            {
+                return zone;
+            }
+        }
+
+        state.zones.push_back(zone_stats { record.name, record.thread });
+        return state.zones.back();
+    }
+
+    [[maybe_unused]] static void set_counter(profiler_state& state,
+                                             const record& item)
+    {
+        for (counter_value& counter : state.counters)
+        {
+            if (counter.name == item.zone.name)
+            {
+                counter.value = item.value;
+                return;
+            }
+        }
+
+        state.counters.push_back(counter_value { item.zone.name, item.value });
+    }
+
+    [[maybe_unused]] static void submit_trace_chunk(profiler_state& state)
+    {
+        {
+            std::lock_guard<std::mutex> lock { state.trace_mutex };
+
+            if (state.trace_backlog.size() + state.trace_chunk.size()
+                > max_trace_backlog)
+            {
+                state.trace_dropped += state.trace_chunk.size();
+            }
+            else if (state.trace_backlog.empty())
+            {
+                // Swap keeps both vectors' capacity, so steady state
+                // tracing doesn't allocate.
+                std::swap(state.trace_backlog, state.trace_chunk);
+            }
+            else
+            {
+                state.trace_backlog.insert(state.trace_backlog.end(),
+                                           state.trace_chunk.begin(),
+                                           state.trace_chunk.end());
+            }
+        }
+
+        state.trace_chunk.clear();
+        state.trace_condition.notify_one();
+    }
+
+    void end_frame()
+    {
+#ifdef ARCI_PROFILER
+        profiler_state& state = get_state();
+        const std::uint64_t frame_end = now();
+        const std::uint32_t threads_number
+            = state.threads_number.load(std::memory_order_acquire);
+
+        for (std::uint32_t i = 0; i < threads_number; ++i)
+        {
+            thread_buffer& buffer = *state.threads[i];
+            const std::uint64_t head
+                = buffer.head.load(std::memory_order_acquire);
+            std::uint64_t tail = buffer.tail.load(std::memory_order_relaxed);
+
+            for (; tail != head; ++tail)
+            {
+                const record& item
+                    = buffer.records[tail & (buffer_capacity - 1)];
+
+                if (state.tracing.load(std::memory_order_relaxed))
+                {
+                    state.trace_chunk.push_back(item);
+                }
+
+                if (item.type == record_type::counter)
+                {
+                    set_counter(state, item);
+                    continue;
+                }
+
+                state.collecting.push_back(item.zone);
+
+                zone_stats& zone = get_zone_stats(state, item.zone);
+                zone.frame_total += item.zone.end - item.zone.start;
+            }
+
+            buffer.tail.store(tail, std::memory_order_release);
+        }
+
+        for (zone_stats& zone : state.zones)
+        {
+            if (zone.average != 0
+                && zone.frame_total > 2 * zone.average
+                && zone.frame_total - zone.average > spike_min_excess)
+            {
+                ++zone.spikes;
+            }
+
+            zone.window_total += zone.frame_total;
+            zone.window_max = std::max(zone.window_max, zone.frame_total);
+        }
+
+        if (++state.window_frames == stats_window)
+        {
+            for (zone_stats& zone : state.zones)
+            {
+                zone.average = zone.window_total / stats_window;
+                zone.max = zone.window_max;
+                zone.window_total = 0;
+                zone.window_max = 0;
+            }
+            state.window_frames = 0;
+        }
+
+        // The panel keeps showing the last frame when paused, but the
+        // statistics go on.
+        if (!state.paused)
+        {
+            std::swap(state.frame_zones, state.collecting);
+            state.frame_start = state.collecting_start;
+            state.frame_end = frame_end;
+        }
+
+        for (zone_stats& zone : state.zones)
+        {
+            zone.frame_total = 0;
+        }
+
+        if (state.tracing.load(std::memory_order_relaxed))
+        {
+            // Frame boundaries as a zone of the calling thread, so
+            // hitches are easy to find on the trace timeline.
+            thread_buffer* buffer = get_thread_buffer();
+            state.trace_chunk.push_back(record {
+                zone_record {
+                    "frame",
+                    state.collecting_start,
+                    frame_end,
+                    0,
+                    buffer != nullptr ? buffer->index : 0,
+                },
+                0.0,
+                record_type::zone,
+            });
+            submit_trace_chunk(state);
+        }
+
+        state.collecting.clear();
+        state.collecting_start = frame_end;
+#endif
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    // Trace Event Format, timestamps are in microseconds:
+    // https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+    [[maybe_unused]] static void append_trace_event(trace_writer& writer,
+                                                    const record& item)
+    {
+        auto out = std::back_inserter(writer.text);
+
+        if (!writer.first_event)
+        {
+            fmt::format_to(out, ",\n");
+        }
+        writer.first_event = false;
+
+        const zone_record& zone = item.zone;
+
+        if (item.type == record_type::counter)
+        {
+            fmt::format_to(out,
+                           R"({{"name":"{}","ph":"C","ts":{:.3f},)"
+                           R"("pid":1,"tid":{},"args":{{"value":{}}}}})",
+                           zone.name,
+                           zone.start * 0.001,
+                           zone.thread,
+                           item.value);
+        }
+        else
+        {
+            fmt::format_to(out,
+                           R"({{"name":"{}","ph":"X","ts":{:.3f},)"
+                           R"("dur":{:.3f},"pid":1,"tid":{}}})",
+                           zone.name,
+                           zone.start * 0.001,
+                           (zone.end - zone.start) * 0.001,
+                           zone.thread);
+        }
+    }
+
+    static void flush_trace_text(trace_writer& writer)
+    {
+        std::fwrite(writer.text.data(), 1, writer.text.size(), writer.file);
+        writer.text.clear();
+    }
+
+    [[maybe_unused]] static void run_trace_writer(profiler_state& state)
+    {
+        trace_writer& writer = state.writer;
+        bool stop { false };
+
+        while (!stop)
+        {
+            {
+                std::unique_lock<std::mutex> lock { state.trace_mutex };
+                state.trace_condition.wait(lock, [&state] {
+                    return state.trace_stop || !state.trace_backlog.empty();
+                });
+
+                std::swap(writer.records, state.trace_backlog);
+                stop = state.trace_stop;
+            }
+
+            for (const record& item : writer.records)
+            {
+                append_trace_event(writer, item);
+            }
+            writer.records.clear();
+
+            flush_trace_text(writer);
+        }
+
+        // Thread names are metadata events, they may go anywhere in the
+        // file and are written last when every thread is known.
+        const std::uint32_t threads_number
+            = state.threads_number.load(std::memory_order_acquire);
+        auto out = std::back_inserter(writer.text);
+
+        for (std::uint32_t i = 0; i < threads_number; ++i)
+        {
+            fmt::format_to(out,
+                           R"({}{{"name":"thread_name","ph":"M","pid":1,)"
+                           R"("tid":{},"args":{{"name":"{}"}}}})",
+                           writer.first_event ? "" : ",\n",
+                           i,
+                           state.threads[i]->name.load(
+                               std::memory_order_relaxed));
+            writer.first_event = false;
+        }
+
+        fmt::format_to(out, "\n],\"displayTimeUnit\":\"ms\"}}\n");
+        flush_trace_text(writer);
+    }
+
+    bool start_trace(const char* path)
+    {
+#ifdef ARCI_PROFILER
+        profiler_state& state = get_state();
+
+        if (state.tracing.load())
+        {
+            return true;
+        }
+
+        state.writer.file = std::fopen(path, "wb");
+        if (state.writer.file == nullptr)
+        {
+            fmt::print("Can't open trace file '{}'\n", path);
+            return false;
+        }
+
+        std::fputs("{\"traceEvents\":[\n", state.writer.file);
+        state.writer.first_event = true;
+        state.trace_stop = false;
+        state.trace_dropped = 0;
+        state.trace_thread = std::thread { run_trace_writer, std::ref(state) };
+        state.tracing.store(true);
+
+        fmt::print("Trace started: {}\n", path);
+        return true;
+#else
+        fmt::print("Can't trace to '{}': the profiler is compiled out\n",
+                   path);
+        return false;
+#endif
+    }
+
+    void stop_trace()
+    {
+        profiler_state& state = get_state();
+
+        if (!state.tracing.load())
+        {
+            return;
+        }
+
+        state.tracing.store(false);
+        {
+            std::lock_guard<std::mutex> lock { state.trace_mutex };
+            state.trace_stop = true;
+        }
+        state.trace_condition.notify_one();
+        state.trace_thread.join();
+
+        std::fclose(state.writer.file);
+        state.writer.file = nullptr;
+
+        if (state.trace_dropped != 0)
+        {
+            fmt::print("Trace stopped, {} events were dropped: the disk "
+                       "didn't keep up\n",
+                       state.trace_dropped);
+        }
+        else
+        {
+            fmt::print("Trace stopped\n");
+        }
+    }
+
+    bool is_tracing() noexcept
+    {
+        return get_state().tracing.load(std::memory_order_relaxed);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    [[maybe_unused]] static ImU32 get_zone_color(const char* name)
+    {
+        // Zone names are literals, so the pointer is a stable hash.
+        std::uintptr_t hash = reinterpret_cast<std::uintptr_t>(name);
+        hash ^= hash >> 17;
+        hash *= 0x9e3779b1u;
+
+        return IM_COL32(96 + (hash & 0x7f),
+                        96 + ((hash >> 8) & 0x7f),
+                        96 + ((hash >> 16) & 0x7f),
+                        255);
+    }
+
+    [[maybe_unused]] static void draw_flame_graph(
+        const profiler_state& state,
+        const std::uint32_t thread)
+    {
+        std::uint32_t max_depth { 0 };
+        bool has_zones { false };
+
+        for (const zone_record& record : state.frame_zones)
+        {
+            if (record.thread == thread)
+            {
+                max_depth = std::max(max_depth, record.depth);
+                has_zones = true;
+            }
+        }
+
+        if (!has_zones)
+        {
+            return;
+        }
+
+        ImGui::TextUnformatted(
+            state.threads[thread]->name.load(std::memory_order_relaxed));
+
+        const float row_height = ImGui::GetTextLineHeightWithSpacing();
+        const ImVec2 origin = ImGui::GetCursorScreenPos();
+        const ImVec2 size { std::max(ImGui::GetContentRegionAvail().x, 100.f),
+                            row_height * (max_depth + 1) };
+        ImGui::InvisibleButton("##flame_graph", size);
+
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+        draw_list->PushClipRect(origin,
+                                ImVec2(origin.x + size.x, origin.y + size.y),
+                                true);
+
+        const double frame_duration = static_cast<double>(
+            std::max<std::uint64_t>(state.frame_end - state.frame_start, 1));
+        const double scale = size.x / frame_duration;
+
+        for (const zone_record& record : state.frame_zones)
+        {
+            if (record.thread != thread || record.end <= state.frame_start)
+            {
+                continue;
+            }
+
+            const std::uint64_t start
+                = std::max(record.start, state.frame_start);
+            const ImVec2 min {
+                origin.x
+                    + static_cast<float>((start - state.frame_start) * scale),
+                origin.y + row_height * record.depth
+            };
+            const ImVec2 max {
+                std::max(min.x + 1.f,
+                         origin.x
+                             + static_cast<float>(
+                                 (record.end - state.frame_start) * scale)),
+                min.y + row_height - 1.f
+            };
+
+            draw_list->AddRectFilled(min, max, get_zone_color(record.name));
+
+            if (max.x - min.x > ImGui::CalcTextSize(record.name).x + 4.f)
+            {
+                draw_list->AddText(ImVec2(min.x + 2.f, min.y),
+                                   IM_COL32(0, 0, 0, 255),
+                                   record.name);
+            }
+
+            if (ImGui::IsMouseHoveringRect(min, max))
+            {
+                ImGui::SetTooltip("%s: %.3f ms",
+                                  record.name,
+                                  (record.end - record.start) * 1e-6);
+            }
+        }
+
+        draw_list->PopClipRect();
+    }
+
+    void draw_panel()
+    {
+        ImGui::SetNextWindowSize(ImVec2(520.f, 420.f), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Profiler");
+
+#ifdef ARCI_PROFILER
+        profiler_state& state = get_state();
+        const std::uint32_t threads_number
+            = state.threads_number.load(std::memory_order_acquire);
+
+        ImGui::Checkbox("Pause", &state.paused);
+        ImGui::SameLine();
+        ImGui::Text("frame: %.3f ms",
+                    (state.frame_end - state.frame_start) * 1e-6);
+        if (state.tracing.load(std::memory_order_relaxed))
+        {
+            ImGui::SameLine();
+            ImGui::TextColored(ImVec4(1.f, 0.3f, 0.3f, 1.f), "TRACING");
+        }
+
+        std::uint64_t dropped { 0 };
+        for (std::uint32_t i = 0; i < threads_number; ++i)
+        {
+            dropped += state.threads[i]->dropped.load(
+                std::memory_order_relaxed);
+        }
+        if (dropped != 0)
+        {
+            ImGui::SameLine();
+            ImGui::Text("dropped zones: %llu",
+                        static_cast<unsigned long long>(dropped));
+        }
+
+        for (std::uint32_t i = 0; i < threads_number; ++i)
+        {
+            ImGui::PushID(static_cast<int>(i));
+            draw_flame_graph(state, i);
+            ImGui::PopID();
+        }
+
+        for (const counter_value& counter : state.counters)
+        {
+            ImGui::Text("%s: %g", counter.name, counter.value);
+        }
+
+        constexpr ImGuiTableFlags table_flags = ImGuiTableFlags_Borders
+            | ImGuiTableFlags_RowBg
+            | ImGuiTableFlags_ScrollY;
+
+        if (ImGui::BeginTable("##zones", 5, table_flags))
+        {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Zone");
+            ImGui::TableSetupColumn("Thread");
+            ImGui::TableSetupColumn("Avg, ms");
+            ImGui::TableSetupColumn("Max, ms");
+            ImGui::TableSetupColumn("Spikes");
+            ImGui::TableHeadersRow();
+
+            for (const zone_stats& zone : state.zones)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(zone.name);
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(state.threads[zone.thread]->name.load(
+                    std::memory_order_relaxed));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", zone.average * 1e-6);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", zone.max * 1e-6);
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu",
+                            static_cast<unsigned long long>(zone.spikes));
+            }
+
+            ImGui::EndTable();
+        }
+#else
+        ImGui::TextUnformatted("The profiler is compiled out. "
+                               "Configure with -DARCI_PROFILER=ON.");
+#endif
+
+        ImGui::End();
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+} // namespace arci::profiler
+
+///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,221 @@
+#include "bench.hxx"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <numeric>
+
+namespace
+{
+    std::atomic<bool> allocations_counting { false };
+    std::atomic<std::uint64_t> allocations_number { 0 };
+}
+
+// Counting replacements of the global allocation functions. Counting is
+// off until a benchmark turns it on, so a normal run only pays for one
+// relaxed load. The array and nothrow forms are implemented by the
+// standard library on top of these, the std::align_val_t forms are not
+// and aren't counted.
+void* operator new(std::size_t size)
+{
+    if (allocations_counting.load(std::memory_order_relaxed))
+    {
+        allocations_number.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (void* pointer = std::malloc(size == 0 ? 1 : size))
+    {
+        return pointer;
+    }
+
+    throw std::bad_alloc {};
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace arcanoid
+{
+    std::optional<bench_scenario> parse_bench_scenario(
+        const std::string_view name)
+    {
+        if (name == "default")
+        {
+            return bench_scenario::standard;
+        }
+        if (name == "bricks-100k")
+        {
+            return bench_scenario::bricks_100k;
+        }
+        if (name == "multiball")
+        {
+            return bench_scenario::multiball;
+        }
+
+        return {};
+    }
+
+    const char* get_bench_scenario_name(const bench_scenario scenario)
+    {
+        switch (scenario)
+        {
+        case bench_scenario::standard:
+            return "default";
+        case bench_scenario::bricks_100k:
+            return "bricks-100k";
+        case bench_scenario::multiball:
+            return "multiball";
+        }
+
+        return "unknown";
+    }
+
+    void start_allocations_counting() noexcept
+    {
+        allocations_counting.store(true, std::memory_order_relaxed);
+    }
+
+    std::uint64_t get_allocations_number() noexcept
+    {
+        return allocations_number.load(std::memory_order_relaxed);
+    }
+
+    arci::input_snapshot get_autopilot_input(const coordinator& a_coordinator)
+    {
+        arci::input_snapshot input {};
+
+        const auto platform = a_coordinator.collidable_ids.find("platform");
+        if (platform == a_coordinator.collidable_ids.end())
+        {
+            return input;
+        }
+
+        const position& platform_pos
+            = a_coordinator.positions.at(platform->second);
+        const float platform_center
+            = (platform_pos.vertices[0].x + platform_pos.vertices[1].x) / 2.f;
+        const float dead_zone
+            = (platform_pos.vertices[1].x - platform_pos.vertices[0].x) / 4.f;
+
+        // Follow the ball closest to the bottom of the screen.
+        const position* lowest_ball { nullptr };
+        for (const auto& [ball_id, _] : a_coordinator.balls)
+        {
+            const position& ball_pos = a_coordinator.positions.at(ball_id);
+            if (lowest_ball == nullptr
+                || ball_pos.vertices[2].y > lowest_ball->vertices[2].y)
+            {
+                lowest_ball = &ball_pos;
+            }
+        }
+
+        if (lowest_ball == nullptr)
+        {
+            return input;
+        }
+
+        const float ball_center
+            = (lowest_ball->vertices[0].x + lowest_ball->vertices[1].x) / 2.f;
+
+        if (ball_center < platform_center - dead_zone)
+        {
+            input.held.set(static_cast<std::size_t>(arci::keys::left));
+        }
+        else if (ball_center > platform_center + dead_zone)
+        {
+            input.held.set(static_cast<std::size_t>(arci::keys::right));
+        }
+
+        return input;
+    }
+
+    void bench_recorder::add_frame(const std::uint64_t update_ns,
+                                   const std::uint64_t render_ns,
+                                   const std::uint64_t swap_ns,
+                                   const std::uint64_t allocations)
+    {
+        m_update_ns.push_back(update_ns);
+        m_render_ns.push_back(render_ns);
+        m_swap_ns.push_back(swap_ns);
+        m_allocations += allocations;
+    }
+
+    void bench_recorder::add_snapshot(const std::uint64_t save_ns,
+                                      const std::uint64_t delta_ns,
+                                      const std::uint64_t restore_ns,
+                                      const std::size_t snapshot_bytes,
+                                      const std::size_t delta_bytes)
+    {
+        m_snapshot_save_ns.push_back(save_ns);
+        m_snapshot_delta_ns.push_back(delta_ns);
+        m_snapshot_restore_ns.push_back(restore_ns);
+        m_snapshot_bytes += snapshot_bytes;
+        m_delta_bytes += delta_bytes;
+    }
+
+    static double get_mean_us(const std::vector<std::uint64_t>& values)
+    {
+        if (values.empty())
+        {
+            return 0.0;
+        }
+
+        return std::accumulate(values.begin(), values.end(), 0.0)
+            / values.size() / 1000.0;
+    }
+
+    static double get_p99_us(std::vector<std::uint64_t> values)
+    {
+        if (values.empty())
+        {
+            return 0.0;
+        }
+
+        const std::size_t index = values.size() * 99 / 100;
+        std::nth_element(values.begin(),
+                         values.begin() + index,
+                         values.end());
+        return values[index] / 1000.0;
+    }
+
+    void bench_recorder::print(const bench_scenario scenario) const
+    {
+        const std::size_t frames = m_update_ns.size();
+        const std::size_t snapshots = m_snapshot_save_ns.size();
+
+        fmt::print("{{\"scenario\":\"{}\",\"frames\":{},"
+                   "\"update_mean_us\":{:.3f},\"update_p99_us\":{:.3f},"
+                   "\"render_mean_us\":{:.3f},\"render_p99_us\":{:.3f},"
+                   "\"swap_mean_us\":{:.3f},"
+                   "\"allocations_per_frame\":{:.2f},"
+                   "\"snapshot_save_mean_us\":{:.3f},"
+                   "\"snapshot_delta_mean_us\":{:.3f},"
+                   "\"snapshot_restore_mean_us\":{:.3f},"
+                   "\"snapshot_bytes\":{},\"delta_bytes\":{}}}\n",
+                   get_bench_scenario_name(scenario),
+                   frames,
+                   get_mean_us(m_update_ns),
+                   get_p99_us(m_update_ns),
+                   get_mean_us(m_render_ns),
+                   get_p99_us(m_render_ns),
+                   get_mean_us(m_swap_ns),
+                   frames != 0
+                       ? static_cast<double>(m_allocations) / frames
+                       : 0.0,
+                   get_mean_us(m_snapshot_save_ns),
+                   get_mean_us(m_snapshot_delta_ns),
+                   get_mean_us(m_snapshot_restore_ns),
+                   snapshots != 0 ? m_snapshot_bytes / snapshots : 0,
+                   snapshots != 0 ? m_delta_bytes / snapshots : 0);
+    }
+}
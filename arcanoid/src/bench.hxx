@@ -0,0 +1,69 @@
+#pragma once
+
+#include "coordinator.hxx"
+#include "engine.hxx"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace arcanoid
+{
+    // Levels for `--bench`. `standard` is the normal level, the others
+    // stress the entity loops and the sprite submission.
+    enum class bench_scenario
+    {
+        standard,
+        bricks_100k,
+        multiball,
+    };
+
+    std::optional<bench_scenario> parse_bench_scenario(
+        const std::string_view name);
+
+    const char* get_bench_scenario_name(const bench_scenario scenario);
+
+    // Turns on counting of operator new calls. Only benchmarks need it.
+    void start_allocations_counting() noexcept;
+
+    // Number of operator new calls since start_allocations_counting().
+    std::uint64_t get_allocations_number() noexcept;
+
+    // Scripted player for benchmarks: keeps the platform under the lowest
+    // ball, so runs are long and reproducible.
+    arci::input_snapshot get_autopilot_input(const coordinator& a_coordinator);
+
+    // Per frame measurements of a benchmark run, printed as one JSON
+    // object on stdout.
+    class bench_recorder
+    {
+    public:
+        void add_frame(const std::uint64_t update_ns,
+                       const std::uint64_t render_ns,
+                       const std::uint64_t swap_ns,
+                       const std::uint64_t allocations);
+
+        // World snapshot costs: a full snapshot, a delta against the
+        // previous frame and a restore.
+        void add_snapshot(const std::uint64_t save_ns,
+                          const std::uint64_t delta_ns,
+                          const std::uint64_t restore_ns,
+                          const std::size_t snapshot_bytes,
+                          const std::size_t delta_bytes);
+
+        void print(const bench_scenario scenario) const;
+
+    private:
+        std::vector<std::uint64_t> m_update_ns {};
+        std::vector<std::uint64_t> m_render_ns {};
+        std::vector<std::uint64_t> m_swap_ns {};
+        std::uint64_t m_allocations {};
+
+        std::vector<std::uint64_t> m_snapshot_save_ns {};
+        std::vector<std::uint64_t> m_snapshot_delta_ns {};
+        std::vector<std::uint64_t> m_snapshot_restore_ns {};
+        std::uint64_t m_snapshot_bytes {};
+        std::uint64_t m_delta_bytes {};
+    };
+}
@@ -32,6 +32,11 @@ namespace arcanoid
     {
     };
 
+    // Tags balls among the collidable entities.
+    struct ball
+    {
+    };
+
     struct life
     {
         std::uint32_t lives_number {};
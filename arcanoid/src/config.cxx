@@ -0,0 +1,291 @@
+#include "config.hxx"
+
+#include <fmt/core.h>
+
+#include <charconv>
+#include <fstream>
+#include <system_error>
+
+namespace arcanoid
+{
+    template<typename T>
+    static bool parse_number(const std::string_view text, T& value)
+    {
+        const char* end = text.data() + text.size();
+        const auto [last, error] = std::from_chars(text.data(), end, value);
+        return error == std::errc {} && last == end;
+    }
+
+    // "1280x720", "3.2" and similar pairs of numbers.
+    template<typename T>
+    static bool parse_pair(const std::string_view text,
+                           const char separator,
+                           T& first,
+                           T& second)
+    {
+        const std::size_t position = text.find(separator);
+        return position != std::string_view::npos
+            && parse_number(text.substr(0, position), first)
+            && parse_number(text.substr(position + 1), second);
+    }
+
+    static bool parse_bool(const std::string_view text, bool& value)
+    {
+        if (text == "true" || text == "on" || text == "1")
+        {
+            value = true;
+            return true;
+        }
+        if (text == "false" || text == "off" || text == "0")
+        {
+            value = false;
+            return true;
+        }
+        return false;
+    }
+
+    static std::string_view trim(std::string_view text)
+    {
+        constexpr std::string_view spaces { " \t\r" };
+
+        const std::size_t first = text.find_first_not_of(spaces);
+        if (first == std::string_view::npos)
+        {
+            return {};
+        }
+
+        const std::size_t last = text.find_last_not_of(spaces);
+        return text.substr(first, last - first + 1);
+    }
+
+    static bool set_option_value(game_options& options,
+                                 const std::string_view name,
+                                 const std::string_view value,
+                                 bool& is_known)
+    {
+        is_known = true;
+
+        arci::engine_options& engine = options.engine;
+
+        if (name == "headless")
+        {
+            return parse_bool(value, engine.headless);
+        }
+        if (name == "frames")
+        {
+            return parse_number(value, options.frames);
+        }
+        if (name == "trace")
+        {
+            options.trace_file = value;
+            options.trace = true;
+            return !value.empty();
+        }
+        if (name == "bench")
+        {
+            options.bench = parse_bench_scenario(value);
+            return options.bench.has_value();
+        }
+        if (name == "record")
+        {
+            options.record_file = value;
+            return !value.empty();
+        }
+        if (name == "replay")
+        {
+            options.replay_file = value;
+            return !value.empty();
+        }
+        if (name == "fps-limit")
+        {
+            return parse_number(value, options.fps_limit);
+        }
+        if (name == "vsync")
+        {
+            if (value == "off")
+            {
+                engine.vsync = arci::vsync_mode::off;
+            }
+            else if (value == "on")
+            {
+                engine.vsync = arci::vsync_mode::on;
+            }
+            else if (value == "adaptive")
+            {
+                engine.vsync = arci::vsync_mode::adaptive;
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        }
+        if (name == "gl-validation")
+        {
+            if (value == "off")
+            {
+                engine.gl_validation = arci::gl_validation_mode::off;
+            }
+            else if (value == "errors")
+            {
+                engine.gl_validation = arci::gl_validation_mode::errors;
+            }
+            else if (value == "trace")
+            {
+                engine.gl_validation = arci::gl_validation_mode::trace;
+            }
+            else
+            {
+                return false;
+            }
+            return true;
+        }
+        if (name == "resolution")
+        {
+            return parse_pair(value,
+                              'x',
+                              engine.window_width,
+                              engine.window_height)
+                && engine.window_width > 0 && engine.window_height > 0;
+        }
+        if (name == "gl-version")
+        {
+            return parse_pair(value,
+                              '.',
+                              engine.gl_major_version,
+                              engine.gl_minor_version);
+        }
+        if (name == "audio-sample-rate")
+        {
+            return parse_number(value, engine.audio_sample_rate)
+                && engine.audio_sample_rate > 0;
+        }
+        if (name == "audio-buffer")
+        {
+            return parse_number(value, engine.audio_buffer_samples)
+                && engine.audio_buffer_samples > 0;
+        }
+        if (name == "tick-rate")
+        {
+            return parse_number(value, options.tick_rate)
+                && options.tick_rate > 0;
+        }
+        if (name == "bricks")
+        {
+            return parse_pair(value,
+                              'x',
+                              options.bricks_columns,
+                              options.bricks_rows)
+                && options.bricks_columns > 0 && options.bricks_rows > 0;
+        }
+        if (name == "texture.background")
+        {
+            options.assets.background_texture = value;
+            return !value.empty();
+        }
+        if (name == "texture.brick")
+        {
+            options.assets.brick_texture = value;
+            return !value.empty();
+        }
+        if (name == "texture.ball")
+        {
+            options.assets.ball_texture = value;
+            return !value.empty();
+        }
+        if (name == "texture.platform")
+        {
+            options.assets.platform_texture = value;
+            return !value.empty();
+        }
+        if (name == "sound.music")
+        {
+            options.assets.music = value;
+            return !value.empty();
+        }
+        if (name == "sound.hit")
+        {
+            options.assets.hit_sound = value;
+            return !value.empty();
+        }
+
+        is_known = false;
+        return false;
+    }
+
+    bool set_option(game_options& options,
+                    const std::string_view name,
+                    const std::string_view value)
+    {
+        const game_options previous = options;
+        bool is_known { false };
+
+        if (set_option_value(options, name, value, is_known))
+        {
+            return true;
+        }
+
+        // A bad value leaves the option as it was.
+        options = previous;
+
+        if (is_known)
+        {
+            fmt::print("Bad value `{}` of option {}\n", value, name);
+        }
+        else
+        {
+            fmt::print("Unknown option: {}\n", name);
+        }
+        return false;
+    }
+
+    bool is_flag_option(const std::string_view name)
+    {
+        return name == "headless";
+    }
+
+    bool load_config(game_options& options,
+                     const std::string& path,
+                     const bool required)
+    {
+        std::ifstream file { path };
+
+        if (!file)
+        {
+            if (required)
+            {
+                fmt::print("Can't open config file {}\n", path);
+            }
+            return !required;
+        }
+
+        std::string line {};
+        std::size_t line_number { 0 };
+
+        while (std::getline(file, line))
+        {
+            ++line_number;
+
+            std::string_view text { line };
+            text = trim(text.substr(0, text.find('#')));
+
+            if (text.empty())
+            {
+                continue;
+            }
+
+            const std::size_t equal_sign = text.find('=');
+
+            if (equal_sign == std::string_view::npos
+                || !set_option(options,
+                               trim(text.substr(0, equal_sign)),
+                               trim(text.substr(equal_sign + 1))))
+            {
+                fmt::print("{}:{}: bad option `{}`\n", path, line_number, text);
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
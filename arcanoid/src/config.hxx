@@ -0,0 +1,52 @@
+#pragma once
+
+#include "game.hxx"
+
+#include <string>
+#include <string_view>
+
+namespace arcanoid
+{
+    // Every option has a name which is used both in the config file
+    // (`name = value` lines, `#` starts a comment) and on the command line
+    // (`--name value`, flags have no value there):
+    //   headless                  flag, run without a window and a sound
+    //                             card;
+    //   frames N                  quit after N frames;
+    //   trace FILE                write a Chrome trace from the start
+    //                             (F2 toggles it);
+    //   bench SCENARIO            headless benchmark of `default`,
+    //                             `bricks-100k` or `multiball` level,
+    //                             1000 frames unless `frames` is given;
+    //   record FILE, replay FILE  input recording and its replay;
+    //   fps-limit N               frame rate cap, 0 means no cap;
+    //   vsync off|on|adaptive     swap interval;
+    //   gl-validation off|errors|trace
+    //                             how GL calls are checked;
+    //   resolution WxH            window size, 1024x768 by default;
+    //   gl-version MAJOR.MINOR    GL core profile version, 3.2 by default;
+    //   audio-sample-rate N       48000 by default;
+    //   audio-buffer N            device buffer in sample frames, 4096 by
+    //                             default;
+    //   tick-rate N               simulation ticks per second, 60 by
+    //                             default;
+    //   bricks WxH                brick wall of the normal level, columns
+    //                             by rows, 10x7 by default;
+    //   texture.background, texture.brick, texture.ball,
+    //   texture.platform, sound.music, sound.hit FILE
+    //                             asset paths.
+    //
+    // Prints the problem and returns false for unknown names and bad
+    // values.
+    bool set_option(game_options& options,
+                    const std::string_view name,
+                    const std::string_view value);
+
+    // Options which take no value on the command line.
+    bool is_flag_option(const std::string_view name);
+
+    // A missing file is an error only if it is `required`.
+    bool load_config(game_options& options,
+                     const std::string& path,
+                     const bool required);
+}
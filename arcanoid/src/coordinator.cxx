@@ -9,6 +9,7 @@ namespace arcanoid
         transformations.erase(id);
         inputs.erase(id);
         collidable_entities.erase(id);
+        balls.erase(id);
 
         for (const auto& [str, c_id] : collidable_ids)
         {
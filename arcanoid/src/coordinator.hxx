@@ -15,6 +15,7 @@ namespace arcanoid
         std::map<entity, transform2d> transformations {};
         std::map<entity, key_inputs> inputs {};
         std::map<entity, collision> collidable_entities {};
+        std::map<entity, ball> balls {};
         std::map<std::string, entity> collidable_ids {};
         std::map<std::string, arci::iaudio_buffer*> sounds {};
 
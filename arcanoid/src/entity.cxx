@@ -7,9 +7,6 @@ namespace arcanoid
 
     entity create_entity() noexcept
     {
-        static entity id { 0 };
-        ++id;
-        entities_number = id;
-        return id;
+        return ++entities_number;
     }
 }
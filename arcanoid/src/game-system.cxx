@@ -4,17 +4,34 @@
 
 #include <imgui.h>
 
+#include <algorithm>
 #include <cmath>
 
 namespace arcanoid
 {
     void sprite_system::render(arci::iengine* engine,
                                coordinator& a_coordinator)
+    {
+        // Sprites which don't collide make the background, it goes
+        // first and is timed on the GPU apart from the world.
+        engine->begin_gpu_pass("gpu/background");
+        render_sprites(engine, a_coordinator, false);
+        engine->end_gpu_pass();
+
+        engine->begin_gpu_pass("gpu/world");
+        render_sprites(engine, a_coordinator, true);
+        engine->end_gpu_pass();
+    }
+
+    void sprite_system::render_sprites(arci::iengine* engine,
+                                       coordinator& a_coordinator,
+                                       const bool collidable)
     {
         for (entity i = 1; i <= entities_number; i++)
         {
             if (a_coordinator.sprites.count(i)
-                && a_coordinator.positions.count(i))
+                && a_coordinator.positions.count(i)
+                && (a_coordinator.collidable_entities.count(i) != 0) == collidable)
             {
                 const position pos = a_coordinator.positions.at(i);
                 arci::itexture* texture = a_coordinator.sprites.at(i).texture;
@@ -86,7 +103,7 @@ namespace arcanoid
     }
 
     void input_system::update(coordinator& a_coordinator,
-                              arci::iengine* engine,
+                              const arci::input_snapshot& input,
                               [[maybe_unused]] const float dt)
     {
         const float t = 1.f / 60.f;
@@ -97,16 +114,16 @@ namespace arcanoid
             if (a_coordinator.inputs.count(i)
                 && a_coordinator.transformations.count(i))
             {
-                if (engine->key_down(arci::keys::left))
+                if (input.is_held(arci::keys::left))
                 {
                     a_coordinator.transformations.at(i).speed_x = -speed;
                 }
-                if (engine->key_down(arci::keys::right))
+                if (input.is_held(arci::keys::right))
                 {
                     a_coordinator.transformations.at(i).speed_x = speed;
                 }
-                if (!engine->key_down(arci::keys::right)
-                    && !engine->key_down(arci::keys::left))
+                if (!input.is_held(arci::keys::right)
+                    && !input.is_held(arci::keys::left))
                 {
                     a_coordinator.transformations.at(i).speed_x = 0.f;
                 }
@@ -120,7 +137,7 @@ namespace arcanoid
     {
         for (auto& collidable : a_coordinator.collidable_entities)
         {
-            if (collidable.first == a_coordinator.collidable_ids.at("ball"))
+            if (a_coordinator.balls.count(collidable.first))
             {
                 resolve_collision_for_ball(collidable.first,
                                            a_coordinator,
@@ -243,8 +260,8 @@ namespace arcanoid
                 continue;
             }
 
-            // There is no any need to check collision to itself.
-            if (ent == id)
+            // Balls don't collide with each other.
+            if (a_coordinator.balls.count(ent))
             {
                 continue;
             }
@@ -438,21 +455,23 @@ namespace arcanoid
         game_status& status,
         const std::size_t screen_height)
     {
-        const entity ball_id = a_coordinator.collidable_ids.at("ball");
-        const position& ball_pos = a_coordinator.positions.at(ball_id);
-
-        if (ball_pos.vertices[2].y > screen_height)
+        // The game is over when the last ball falls out of the screen.
+        for (const auto& [ball_id, _] : a_coordinator.balls)
         {
-            status = game_status::game_over;
+            const position& ball_pos = a_coordinator.positions.at(ball_id);
+
+            if (ball_pos.vertices[2].y <= screen_height)
+            {
+                return;
+            }
         }
+
+        status = game_status::game_over;
     }
 
-    void game_over_system::render(arci::iengine* engine,
-                                  const std::size_t width,
+    void game_over_system::render(const std::size_t width,
                                   const std::size_t height)
     {
-        engine->imgui_new_frame();
-
         const ImGuiViewport* main_viewport = ImGui::GetMainViewport();
         ImGui::SetNextWindowPos(ImVec2(main_viewport->WorkPos.x,
                                        main_viewport->WorkPos.y),
@@ -478,17 +497,12 @@ namespace arcanoid
         ImGui::PopStyleColor();
 
         ImGui::End();
-
-        engine->imgui_render();
     }
 
-    void menu_system::render(arci::iengine* engine,
-                             game_status& status,
+    void menu_system::render(game_status& status,
                              std::size_t width,
                              const std::size_t height)
     {
-        engine->imgui_new_frame();
-
         const ImGuiViewport* main_viewport = ImGui::GetMainViewport();
         ImGui::SetNextWindowPos(ImVec2(main_viewport->WorkPos.x,
                                        main_viewport->WorkPos.y),
@@ -547,7 +561,65 @@ namespace arcanoid
         ImGui::PopStyleColor();
 
         ImGui::End();
+    }
 
-        engine->imgui_render();
+    void debug_overlay_system::render(const cFrameTimer& frame_timer,
+                                      const arci::engine_stats& engine_stats)
+    {
+        const cFrameHistogram& histogram = frame_timer.getHistogram();
+        const cFrameHistogram::Stats stats = histogram.getStats();
+        histogram.getFrameTimesMs(m_frame_times_ms);
+
+        constexpr float ns_to_ms { 0.000001f };
+
+        ImGui::SetNextWindowPos(ImVec2(10.f, 10.f), ImGuiCond_FirstUseEver);
+        ImGui::SetNextWindowBgAlpha(0.75f);
+        ImGui::Begin("Frame time", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+
+        ImGui::Text("FPS: %.1f", frame_timer.getFps());
+        ImGui::Text("p50: %.2f ms  p95: %.2f ms  p99: %.2f ms",
+                    stats.p50 * ns_to_ms,
+                    stats.p95 * ns_to_ms,
+                    stats.p99 * ns_to_ms);
+        ImGui::Text("max: %.2f ms over %u frames",
+                    stats.max * ns_to_ms,
+                    stats.frames);
+        ImGui::Text("hitches (> %.1f ms): %u in window, %llu total",
+                    histogram.getHitchThreshold() * ns_to_ms,
+                    stats.windowHitches,
+                    static_cast<unsigned long long>(stats.totalHitches));
+
+        ImGui::PlotLines("##frame_times",
+                         m_frame_times_ms.data(),
+                         static_cast<int>(m_frame_times_ms.size()),
+                         0,
+                         nullptr,
+                         0.f,
+                         std::max(stats.max * ns_to_ms, 1.f),
+                         ImVec2(360.f, 80.f));
+
+        if (ImGui::CollapsingHeader("Engine", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            ImGui::Text("draw calls: %u, triangles: %llu",
+                        engine_stats.draw_calls,
+                        static_cast<unsigned long long>(engine_stats.triangles));
+            ImGui::Text("uploaded: %llu B vertices, %llu B indices",
+                        static_cast<unsigned long long>(
+                            engine_stats.vertex_bytes_uploaded),
+                        static_cast<unsigned long long>(
+                            engine_stats.index_bytes_uploaded));
+            ImGui::Text("created: %u buffers, %u textures",
+                        engine_stats.buffers_created,
+                        engine_stats.textures_created);
+            ImGui::Text("shader switches: %u, texture binds: %u",
+                        engine_stats.shader_switches,
+                        engine_stats.texture_binds);
+            ImGui::Text("voices: %u, mixer: %.3f ms",
+                        engine_stats.audio_voices,
+                        engine_stats.mixer_time_ns * ns_to_ms);
+            ImGui::Text("events: %u", engine_stats.events);
+        }
+
+        ImGui::End();
     }
 }
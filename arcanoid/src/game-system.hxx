@@ -3,6 +3,10 @@
 #include "coordinator.hxx"
 #include "engine.hxx"
 
+#include "FrameTimer.hxx"
+
+#include <vector>
+
 namespace arcanoid
 {
     struct sprite_system
@@ -12,6 +16,11 @@ namespace arcanoid
 
         std::size_t screen_width {};
         std::size_t screen_height {};
+
+    private:
+        void render_sprites(arci::iengine* engine,
+                            coordinator& a_coordinator,
+                            const bool collidable);
     };
 
     struct transform_system
@@ -21,7 +30,9 @@ namespace arcanoid
 
     struct input_system
     {
-        void update(coordinator& a_coordinator, arci::iengine* engine, const float dt);
+        void update(coordinator& a_coordinator,
+                    const arci::input_snapshot& input,
+                    const float dt);
     };
 
     struct collision_system
@@ -82,16 +93,23 @@ namespace arcanoid
                     game_status& status,
                     const std::size_t screen_height);
 
-        void render(arci::iengine* engine,
-                    std::size_t width,
-                    const std::size_t height);
+        void render(std::size_t width, const std::size_t height);
     };
 
     struct menu_system
     {
-        void render(arci::iengine* engine,
-                    game_status& status,
+        void render(game_status& status,
                     std::size_t width,
                     const std::size_t height);
     };
+
+    // Debug windows on top of the game, toggled with F1.
+    struct debug_overlay_system
+    {
+        void render(const cFrameTimer& frame_timer,
+                    const arci::engine_stats& engine_stats);
+
+    private:
+        std::vector<float> m_frame_times_ms {};
+    };
 }
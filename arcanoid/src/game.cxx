@@ -1,46 +1,199 @@
 #include "game.hxx"
 #include "helper.hxx"
+#include "profiler.hxx"
 
+#include <array>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
 
 namespace arcanoid
 {
-    void game::main_loop()
+    // Menus don't change by themselves, so they are redrawn only for a few
+    // frames after an event or a status change (ImGui needs a couple of
+    // frames to settle), and the loop sleeps in between.
+    static constexpr std::uint32_t idle_wait_ms { 250 };
+    static constexpr std::size_t idle_redraw_frames { 3 };
+
+    static std::uint64_t get_elapsed_ns(
+        const std::chrono::steady_clock::time_point start,
+        const std::chrono::steady_clock::time_point finish)
+    {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start)
+                .count());
+    }
+
+    game::game(const game_options& options)
+        : m_options { options }
+    {
+        // Benchmarks always run unattended.
+        if (m_options.bench)
+        {
+            m_options.engine.headless = true;
+            start_allocations_counting();
+        }
+
+        if (m_options.engine.headless || !m_options.replay_file.empty())
+        {
+            m_status = game_status::game;
+        }
+
+        m_level = m_options.bench.value_or(bench_scenario::standard);
+    }
+
+    bool game::main_loop()
     {
         on_init();
 
         bool loop_continue { true };
+        std::size_t frames_done { 0 };
+        game_status last_status { m_status };
+        std::size_t redraw_frames { idle_redraw_frames };
+
+        ARCI_PROFILE_THREAD("main");
 
         while (loop_continue)
         {
+            if (m_status != last_status)
+            {
+                last_status = m_status;
+                redraw_frames = idle_redraw_frames;
+            }
+
+            if (is_idle())
+            {
+                if (m_engine->wait_events(redraw_frames > 0 ? 0
+                                                            : idle_wait_ms))
+                {
+                    redraw_frames = idle_redraw_frames;
+                }
+                else if (redraw_frames == 0)
+                {
+                    continue;
+                }
+
+                --redraw_frames;
+            }
+
             m_frame_timer.update();
 
             on_event();
 
+            // Late latch: sample the keyboard right before the simulation.
+            m_engine->latch_input();
+            m_input = m_options.bench ? get_autopilot_input(m_coordinator)
+                                      : m_engine->get_input();
+
+            if (m_options.engine.headless && m_status == game_status::game_over)
+            {
+                m_status = game_status::exit;
+            }
+
             if (m_status == game_status::exit)
             {
                 loop_continue = false;
                 break;
             }
 
-            const float frame_delta = m_frame_timer.getFrameDeltaTime();
+            // Headless frames run as fast as possible and real time has
+            // nothing to do with game time.
+            float frame_delta = m_options.engine.headless
+                ? get_tick_time()
+                : m_frame_timer.getFrameDeltaTime();
+
+            // A replay drives both the input and the time step, so the
+            // simulation repeats the recorded one bit for bit.
+            if (m_input_player.is_open() && m_status == game_status::game
+                && !m_input_player.next_tick(m_input, frame_delta))
+            {
+                break;
+            }
+
+            const std::uint64_t allocations_before = get_allocations_number();
+            const auto update_start = std::chrono::steady_clock::now();
+
             on_update(frame_delta);
 
+            const auto render_start = std::chrono::steady_clock::now();
+
             on_render();
+
+            const auto swap_start = std::chrono::steady_clock::now();
+
+            m_engine->swap_buffers();
+
+            const auto frame_finish = std::chrono::steady_clock::now();
+
+            if (m_options.bench)
+            {
+                m_bench_recorder.add_frame(
+                    get_elapsed_ns(update_start, render_start),
+                    get_elapsed_ns(render_start, swap_start),
+                    get_elapsed_ns(swap_start, frame_finish),
+                    get_allocations_number() - allocations_before);
+                measure_snapshots();
+            }
+
+            if (!m_options.engine.headless)
+            {
+                ARCI_PROFILE_SCOPE("frame_pacer::wait");
+                m_frame_pacer.wait();
+            }
+
+            arci::profiler::end_frame();
+
+            ++frames_done;
+            if (m_options.frames != 0 && frames_done >= m_options.frames)
+            {
+                loop_continue = false;
+            }
         }
+
+        if (m_options.bench)
+        {
+            m_bench_recorder.print(*m_options.bench);
+        }
+
+        m_input_recorder.close(m_coordinator);
+
+        if (m_input_player.is_open())
+        {
+            return m_input_player.verify(m_coordinator);
+        }
+
+        return true;
     }
 
     void game::on_event()
     {
-        arci::event event;
-        while (m_engine->process_input(event))
+        ARCI_PROFILE_SCOPE("game::on_event");
+
+        std::array<arci::input_event, 64> events {};
+        std::size_t count {};
+
+        do
         {
-            if (event.is_quitting)
+            count = m_engine->poll_events(events.data(), events.size());
+
+            for (std::size_t i = 0; i < count; i++)
             {
-                m_status = game_status::exit;
-                break;
+                if (events[i].type == arci::input_event_type::quit)
+                {
+                    m_status = game_status::exit;
+                }
+                else if (events[i].type == arci::input_event_type::key_pressed
+                         && events[i].key == arci::keys::debug_overlay)
+                {
+                    m_show_debug_overlay = !m_show_debug_overlay;
+                }
+                else if (events[i].type == arci::input_event_type::key_pressed
+                         && events[i].key == arci::keys::trace_capture)
+                {
+                    toggle_trace();
+                }
             }
-        }
+        } while (count == events.size());
     }
 
     void game::on_update(float dt)
@@ -50,36 +203,119 @@ namespace arcanoid
             return;
         }
 
-        // When debugging dt is too big. So set it being 1/60.
-        dt = std::min(dt, 1.0f / 60.0f);
+        ARCI_PROFILE_SCOPE("game::on_update");
+
+        if (m_input_recorder.is_open())
+        {
+            m_input_recorder.add_tick(m_input, dt);
+        }
+
+        // When debugging dt is too big. So limit it by one tick.
+        dt = std::min(dt, get_tick_time());
 
-        m_game_over_system.update(m_coordinator, m_status, m_screen_h);
-        m_input_system.update(m_coordinator, m_engine.get(), dt);
-        m_collision_system.update(m_coordinator, dt, m_screen_w);
-        m_transform_system.update(m_coordinator, dt);
+        {
+            ARCI_PROFILE_SCOPE("game_over_system");
+            m_game_over_system.update(m_coordinator, m_status, m_screen_h);
+        }
+        {
+            ARCI_PROFILE_SCOPE("input_system");
+            m_input_system.update(m_coordinator, m_input, dt);
+        }
+        {
+            ARCI_PROFILE_SCOPE("collision_system");
+            m_collision_system.update(m_coordinator, dt, m_screen_w);
+        }
+        {
+            ARCI_PROFILE_SCOPE("transform_system");
+            m_transform_system.update(m_coordinator, dt);
+        }
     }
 
     void game::on_render()
     {
-        if (m_status == game_status::game_over)
+        ARCI_PROFILE_SCOPE("game::on_render");
+
+        if (m_status == game_status::game)
         {
-            m_game_over_system.render(m_engine.get(),
-                                      m_screen_w,
-                                      m_screen_h);
+            ARCI_PROFILE_SCOPE("sprite_system");
+            m_sprite_system.render(m_engine.get(), m_coordinator);
+        }
+
+        // ImGui draws on top of the sprites, and only when some window
+        // is actually shown.
+        if (m_status != game_status::game || m_show_debug_overlay)
+        {
+            m_engine->imgui_new_frame();
+
+            if (m_status == game_status::game_over)
+            {
+                m_game_over_system.render(m_screen_w, m_screen_h);
+            }
+            else if (m_status == game_status::main_menu)
+            {
+                m_menu_system.render(m_status, m_screen_w, m_screen_h);
+            }
+
+            if (m_show_debug_overlay)
+            {
+                m_debug_overlay_system.render(m_frame_timer,
+                                              m_engine->get_stats());
+                arci::profiler::draw_panel();
+            }
+
+            m_engine->imgui_render();
         }
-        else if (m_status == game_status::main_menu)
+    }
+
+    float game::get_tick_time() const noexcept
+    {
+        return 1.f / m_options.tick_rate;
+    }
+
+    bool game::is_idle() const noexcept
+    {
+        return !m_options.engine.headless && m_status != game_status::game
+            && !m_show_debug_overlay;
+    }
+
+    void game::measure_snapshots()
+    {
+        const world_snapshot& previous = m_snapshots[m_snapshot_index];
+        m_snapshot_index = (m_snapshot_index + 1) % m_snapshots.size();
+        world_snapshot& current = m_snapshots[m_snapshot_index];
+
+        const auto save_start = std::chrono::steady_clock::now();
+        save_snapshot(m_coordinator, m_snapshot_resources, current);
+        const auto delta_start = std::chrono::steady_clock::now();
+        save_delta(previous, current, m_snapshot_delta);
+        const auto restore_start = std::chrono::steady_clock::now();
+        restore_snapshot(m_coordinator, m_snapshot_resources, current);
+        const auto finish = std::chrono::steady_clock::now();
+
+        // Outside of the timed part: the delta must rebuild the snapshot
+        // it was taken from byte for byte.
+        apply_delta(previous, m_snapshot_delta, m_snapshot_check);
+        arci::CHECK(m_snapshot_delta.is_delta());
+        arci::CHECK(m_snapshot_check.data == current.data);
+
+        m_bench_recorder.add_snapshot(
+            get_elapsed_ns(save_start, delta_start),
+            get_elapsed_ns(delta_start, restore_start),
+            get_elapsed_ns(restore_start, finish),
+            current.data.size(),
+            m_snapshot_delta.data.size());
+    }
+
+    void game::toggle_trace()
+    {
+        if (arci::profiler::is_tracing())
         {
-            m_menu_system.render(m_engine.get(),
-                                 m_status,
-                                 m_screen_w,
-                                 m_screen_h);
+            arci::profiler::stop_trace();
         }
         else
         {
-            m_sprite_system.render(m_engine.get(), m_coordinator);
+            arci::profiler::start_trace(m_options.trace_file.c_str());
         }
-
-        m_engine->swap_buffers();
     }
 
     void game::on_init()
@@ -89,7 +325,8 @@ namespace arcanoid
             arci::engine_destroy
         };
 
-        m_engine->init();
+        m_options.engine.simulated_frame_time = get_tick_time();
+        m_engine->init(m_options.engine);
 
         const auto [w, h] = m_engine->get_screen_resolution();
         m_screen_w = w;
@@ -98,21 +335,64 @@ namespace arcanoid
         m_sprite_system.screen_height = h;
 
         arci::iaudio_buffer* background_sound
-            = m_engine->create_audio_buffer("res/music.wav");
+            = m_engine->create_audio_buffer(m_options.assets.music);
         arci::iaudio_buffer* hit_ball_sound
-            = m_engine->create_audio_buffer("res/hit.wav");
+            = m_engine->create_audio_buffer(m_options.assets.hit_sound);
         m_coordinator.sounds.insert({ "background", background_sound });
         m_coordinator.sounds.insert({ "hit_ball", hit_ball_sound });
 
         m_coordinator.sounds["background"]->play(
             arci::iaudio_buffer::running_mode::for_ever);
 
+        if (!m_options.replay_file.empty())
+        {
+            if (!m_input_player.open(m_options.replay_file))
+            {
+                std::exit(EXIT_FAILURE);
+            }
+            m_level = m_input_player.get_header().level;
+            m_options.tick_rate = m_input_player.get_header().tick_rate;
+        }
+
+        if (!m_options.record_file.empty())
+        {
+            replay_header header {};
+            header.level = m_level;
+            header.tick_rate = m_options.tick_rate;
+
+            if (!m_input_recorder.open(m_options.record_file, header))
+            {
+                std::exit(EXIT_FAILURE);
+            }
+        }
+
         init_world();
         m_frame_timer.restart();
+        m_frame_pacer.setTargetFps(m_options.fps_limit);
+
+        m_snapshot_resources.textures = m_textures;
+        for (const auto& [_, sound] : m_coordinator.sounds)
+        {
+            m_snapshot_resources.sounds.push_back(sound);
+        }
+
+        if (m_options.bench)
+        {
+            save_snapshot(m_coordinator,
+                          m_snapshot_resources,
+                          m_snapshots[m_snapshot_index]);
+        }
+
+        if (m_options.trace)
+        {
+            arci::profiler::start_trace(m_options.trace_file.c_str());
+        }
     }
 
     game::~game()
     {
+        arci::profiler::stop_trace();
+
         for (auto texture : m_textures)
         {
             m_engine->destroy_texture(texture);
@@ -131,24 +411,55 @@ namespace arcanoid
     void game::init_world()
     {
         init_background();
-        init_bricks();
-        init_ball();
+
+        if (m_level == bench_scenario::bricks_100k)
+        {
+            init_bricks(250, 400);
+        }
+        else
+        {
+            init_bricks(m_options.bricks_rows, m_options.bricks_columns);
+        }
+
+        if (m_level == bench_scenario::multiball)
+        {
+            // Fan the balls out upwards, every one with its own angle.
+            constexpr std::size_t balls_number { 1000 };
+            constexpr float speed { 363.f };
+
+            for (std::size_t i = 0; i < balls_number; i++)
+            {
+                const float angle = 0.15f
+                    + 2.84f * static_cast<float>(i) / (balls_number - 1);
+                init_ball(transform2d { speed * std::cos(angle),
+                                        -speed * std::sin(angle) });
+            }
+        }
+        else
+        {
+            init_ball(transform2d { -60.f, -360.f });
+        }
+
         init_platform();
     }
 
-    void game::init_bricks()
+    void game::init_bricks(const std::size_t rows, const std::size_t columns)
     {
         arci::itexture* yellow_brick_texture
-            = m_engine->create_texture("res/yellow_brick.png");
+            = m_engine->create_texture(m_options.assets.brick_texture);
         arci::CHECK_NOTNULL(yellow_brick_texture);
         m_textures.push_back(yellow_brick_texture);
 
-        const float brick_width { m_screen_w / 10.f };
-        const float brick_height { m_screen_h / 20.f };
+        // The default 7 x 10 wall takes the top 7/20 of the screen, bigger
+        // walls are squeezed into the top half.
+        const float brick_width { m_screen_w / static_cast<float>(columns) };
+        const float brick_height { rows <= 10
+                                       ? m_screen_h / 20.f
+                                       : m_screen_h / 2.f / rows };
 
-        for (int i = 0; i < 7; i++)
+        for (std::size_t i = 0; i < rows; i++)
         {
-            for (int j = 0; j < 10; j++)
+            for (std::size_t j = 0; j < columns; j++)
             {
                 entity brick = create_entity();
 
@@ -185,7 +496,7 @@ namespace arcanoid
         entity background = create_entity();
 
         arci::itexture* background_texture
-            = m_engine->create_texture("res/background1.png");
+            = m_engine->create_texture(m_options.assets.background_texture);
         arci::CHECK_NOTNULL(background_texture);
         m_textures.push_back(background_texture);
 
@@ -205,14 +516,19 @@ namespace arcanoid
         arci::CHECK(sprite_inserted);
     }
 
-    void game::init_ball()
+    void game::init_ball(const transform2d& transform)
     {
         entity ball = create_entity();
 
-        arci::itexture* texture
-            = m_engine->create_texture("res/ball.png");
-        arci::CHECK_NOTNULL(texture);
-        m_textures.push_back(texture);
+        // All the balls share one texture.
+        if (m_ball_texture == nullptr)
+        {
+            m_ball_texture
+                = m_engine->create_texture(m_options.assets.ball_texture);
+            arci::CHECK_NOTNULL(m_ball_texture);
+            m_textures.push_back(m_ball_texture);
+        }
+        arci::itexture* texture = m_ball_texture;
 
         const float ball_width { m_screen_w / 45.f };
         const float ball_height { m_screen_w / 45.f };
@@ -236,7 +552,6 @@ namespace arcanoid
             = m_coordinator.sprites.insert({ ball, spr });
         arci::CHECK(sprite_inserted);
 
-        transform2d transform { -60.f, -360.f };
         const auto [it3, transform_inserted]
             = m_coordinator.transformations.insert({ ball, transform });
         arci::CHECK(transform_inserted);
@@ -247,9 +562,12 @@ namespace arcanoid
                 { ball, collision_component });
         arci::CHECK(collision_inserted);
 
-        const auto [it5, collision_id_inserted]
-            = m_coordinator.collidable_ids.insert({ "ball", ball });
-        arci::CHECK(collision_id_inserted);
+        const auto [it5, ball_inserted]
+            = m_coordinator.balls.insert({ ball, arcanoid::ball {} });
+        arci::CHECK(ball_inserted);
+
+        // The first ball is also known by name.
+        m_coordinator.collidable_ids.insert({ "ball", ball });
     }
 
     void game::init_platform()
@@ -257,7 +575,7 @@ namespace arcanoid
         entity platform = create_entity();
 
         arci::itexture* texture
-            = m_engine->create_texture("res/platform1.png");
+            = m_engine->create_texture(m_options.assets.platform_texture);
         arci::CHECK_NOTNULL(texture);
         m_textures.push_back(texture);
 
@@ -1,23 +1,85 @@
 #pragma once
 
+#include "bench.hxx"
 #include "component.hxx"
 #include "coordinator.hxx"
 #include "engine.hxx"
 #include "entity.hxx"
 #include "game-system.hxx"
+#include "replay.hxx"
+#include "snapshot.hxx"
 
+#include "FramePacer.hxx"
 #include "FrameTimer.hxx"
 
+#include <array>
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 
 namespace arcanoid
 {
+    struct game_assets
+    {
+        std::string background_texture { "res/background1.png" };
+        std::string brick_texture { "res/yellow_brick.png" };
+        std::string ball_texture { "res/ball.png" };
+        std::string platform_texture { "res/platform1.png" };
+        std::string music { "res/music.adpcm" };
+        std::string hit_sound { "res/hit.wav" };
+    };
+
+    // Filled from the config file and the command line, see config.hxx.
+    struct game_options
+    {
+        // Window, GL context, audio device, vsync and GL validation.
+        // `engine.headless` is an unattended run: the menu is skipped,
+        // the simulation uses a fixed time step and the game quits on
+        // game over.
+        arci::engine_options engine {};
+
+        // Simulation ticks per second: the fixed time step of headless
+        // runs and the longest step of interactive ones.
+        std::uint32_t tick_rate { 60 };
+
+        // Brick wall of the normal level.
+        std::size_t bricks_rows { 7 };
+        std::size_t bricks_columns { 10 };
+
+        game_assets assets {};
+
+        // Quit after this number of frames. Zero means no limit.
+        std::size_t frames { 0 };
+
+        // Chrome trace output. F2 starts and stops a capture, `trace`
+        // starts one right on launch.
+        std::string trace_file { "arcanoid-trace.json" };
+        bool trace { false };
+
+        // Frame rate cap, zero means none. Ignored in headless mode,
+        // which runs as fast as possible.
+        std::uint32_t fps_limit { 0 };
+
+        // Benchmark run: implies `headless`, the platform is driven by
+        // an autopilot and timings are printed as JSON at the end.
+        std::optional<bench_scenario> bench {};
+
+        // Input recording of the whole game, and a recording to play
+        // instead of the live input. A replay skips the menu, takes the
+        // level and the time steps from the file and checks the final
+        // world state against the recorded one. Resolution and level
+        // layout options should be the same as in the recorded run.
+        std::string record_file {};
+        std::string replay_file {};
+    };
+
     class game final
     {
     public:
-        void main_loop();
+        explicit game(const game_options& options);
+        // Returns false if a replay diverged from its recording.
+        bool main_loop();
         ~game();
 
     private:
@@ -25,14 +87,19 @@ namespace arcanoid
         void on_event();
         void on_update(float dt);
         void on_render();
+        void toggle_trace();
+        void measure_snapshots();
+        bool is_idle() const noexcept;
+        float get_tick_time() const noexcept;
 
         void init_world();
-        void init_bricks();
-        void init_ball();
+        void init_bricks(const std::size_t rows, const std::size_t columns);
+        void init_ball(const transform2d& transform);
         void init_platform();
         void init_background();
 
         std::vector<arci::itexture*> m_textures {};
+        arci::itexture* m_ball_texture { nullptr };
 
         coordinator m_coordinator {};
         input_system m_input_system {};
@@ -41,14 +108,31 @@ namespace arcanoid
         collision_system m_collision_system {};
         game_over_system m_game_over_system {};
         menu_system m_menu_system {};
+        debug_overlay_system m_debug_overlay_system {};
+        bool m_show_debug_overlay { false };
 
         std::unique_ptr<arci::iengine,
                         void (*)(arci::iengine*)>
             m_engine { nullptr, nullptr };
+        game_options m_options {};
         std::size_t m_screen_w {};
         std::size_t m_screen_h {};
         game_status m_status { game_status::main_menu };
+        bench_scenario m_level { bench_scenario::standard };
+
+        // Input the simulation sees this frame.
+        arci::input_snapshot m_input {};
+        bench_recorder m_bench_recorder {};
+        input_recorder m_input_recorder {};
+        input_player m_input_player {};
+
+        snapshot_resources m_snapshot_resources {};
+        std::array<world_snapshot, 2> m_snapshots {};
+        std::size_t m_snapshot_index {};
+        world_snapshot m_snapshot_delta {};
+        world_snapshot m_snapshot_check {};
 
         cFrameTimer m_frame_timer;
+        cFramePacer m_frame_pacer;
     };
 }
@@ -1,8 +1,85 @@
+#include "config.hxx"
 #include "game.hxx"
 
-int main(int, char**)
+#include <fmt/core.h>
+
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+// Options come from `arcanoid.cfg` in the working directory if it exists,
+// or from the file given with `--config FILE`, and then from the command
+// line as `--name value`. See config.hxx for the list.
+static arcanoid::game_options parse_options(int argc, char** argv)
+{
+    arcanoid::game_options options {};
+
+    // The config file goes first, so the command line overrides it.
+    std::string config_file { "arcanoid.cfg" };
+    bool is_config_required { false };
+
+    for (int i = 1; i + 1 < argc; i++)
+    {
+        if (std::string_view { argv[i] } == "--config")
+        {
+            config_file = argv[i + 1];
+            is_config_required = true;
+        }
+    }
+
+    if (!arcanoid::load_config(options, config_file, is_config_required))
+    {
+        std::exit(EXIT_FAILURE);
+    }
+
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string_view option { argv[i] };
+
+        if (option == "--config" && i + 1 < argc)
+        {
+            ++i;
+            continue;
+        }
+
+        if (option.substr(0, 2) != "--")
+        {
+            fmt::print("Unknown option: {}\n", option);
+            std::exit(EXIT_FAILURE);
+        }
+
+        const std::string_view name { option.substr(2) };
+        bool is_set { false };
+
+        if (arcanoid::is_flag_option(name))
+        {
+            is_set = arcanoid::set_option(options, name, "true");
+        }
+        else if (i + 1 < argc)
+        {
+            is_set = arcanoid::set_option(options, name, argv[++i]);
+        }
+        else
+        {
+            fmt::print("Option {} needs a value\n", option);
+        }
+
+        if (!is_set)
+        {
+            std::exit(EXIT_FAILURE);
+        }
+    }
+
+    if (options.bench && options.frames == 0)
+    {
+        options.frames = 1000;
+    }
+
+    return options;
+}
+
+int main(int argc, char** argv)
 {
-    arcanoid::game arcanoid {};
-    arcanoid.main_loop();
-    return EXIT_SUCCESS;
+    arcanoid::game arcanoid { parse_options(argc, argv) };
+    return arcanoid.main_loop() ? EXIT_SUCCESS : EXIT_FAILURE;
 }
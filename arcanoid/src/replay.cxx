@@ -0,0 +1,305 @@
+#include "replay.hxx"
+
+#include <fmt/core.h>
+
+#include <array>
+#include <cstring>
+#include <iterator>
+
+namespace arcanoid
+{
+    static constexpr std::array<char, 4> header_magic { 'A', 'R', 'C', 'R' };
+    static constexpr std::array<char, 4> footer_magic { 'A', 'R', 'C', 'E' };
+    static constexpr std::uint16_t replay_version { 2 };
+
+    static constexpr std::size_t header_size { 20 };
+    static constexpr std::size_t tick_size { 10 };
+    static constexpr std::size_t footer_size { 20 };
+
+    // Keys are stored as 16 bit masks. The two top bits are never set, so
+    // the end of a tick can't be mistaken for the footer magic.
+    static_assert(arci::input_snapshot::keys_number <= 14);
+
+    static void write_bytes(std::ofstream& file,
+                            std::uint64_t value,
+                            const std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; i++)
+        {
+            file.put(static_cast<char>(value & 0xff));
+            value >>= 8;
+        }
+    }
+
+    static std::uint64_t read_bytes(const std::uint8_t* data,
+                                    const std::size_t size)
+    {
+        std::uint64_t value { 0 };
+        for (std::size_t i = size; i > 0; i--)
+        {
+            value = (value << 8) | data[i - 1];
+        }
+        return value;
+    }
+
+    static std::uint32_t float_to_bits(const float value)
+    {
+        std::uint32_t bits {};
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    static float bits_to_float(const std::uint32_t bits)
+    {
+        float value {};
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    template<std::size_t N>
+    static std::uint16_t bits_to_mask(const std::bitset<N>& bits)
+    {
+        return static_cast<std::uint16_t>(bits.to_ulong());
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    std::uint64_t get_world_hash(const coordinator& a_coordinator)
+    {
+        // FNV-1a.
+        std::uint64_t hash { 14695981039346656037ull };
+
+        auto add = [&hash](const std::uint64_t value) {
+            for (std::size_t i = 0; i < 8; i++)
+            {
+                hash ^= (value >> (i * 8)) & 0xff;
+                hash *= 1099511628211ull;
+            }
+        };
+
+        for (const auto& [id, pos] : a_coordinator.positions)
+        {
+            add(id);
+            for (const glm::vec2& vertex : pos.vertices)
+            {
+                add(float_to_bits(vertex.x));
+                add(float_to_bits(vertex.y));
+            }
+        }
+
+        for (const auto& [id, transform] : a_coordinator.transformations)
+        {
+            add(id);
+            add(float_to_bits(transform.speed_x));
+            add(float_to_bits(transform.speed_y));
+        }
+
+        return hash;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    bool input_recorder::open(const std::string& path,
+                              const replay_header& header)
+    {
+        m_file.open(path, std::ios::binary | std::ios::trunc);
+
+        if (!m_file)
+        {
+            fmt::print("Can't open replay file {} for writing\n", path);
+            return false;
+        }
+
+        m_file.write(header_magic.data(), header_magic.size());
+        write_bytes(m_file, replay_version, 2);
+        write_bytes(m_file, static_cast<std::uint64_t>(header.level), 2);
+        write_bytes(m_file, header.seed, 8);
+        write_bytes(m_file, header.tick_rate, 4);
+        m_ticks = 0;
+
+        return true;
+    }
+
+    bool input_recorder::is_open() const noexcept
+    {
+        return m_file.is_open();
+    }
+
+    void input_recorder::add_tick(const arci::input_snapshot& input,
+                                  const float dt)
+    {
+        write_bytes(m_file, float_to_bits(dt), 4);
+        write_bytes(m_file, bits_to_mask(input.held), 2);
+        write_bytes(m_file, bits_to_mask(input.pressed), 2);
+        write_bytes(m_file, bits_to_mask(input.released), 2);
+        ++m_ticks;
+    }
+
+    void input_recorder::close(const coordinator& a_coordinator)
+    {
+        if (!m_file.is_open())
+        {
+            return;
+        }
+
+        write_bytes(m_file, m_ticks, 8);
+        write_bytes(m_file, get_world_hash(a_coordinator), 8);
+        m_file.write(footer_magic.data(), footer_magic.size());
+        m_file.close();
+
+        fmt::print("Recorded {} ticks\n", m_ticks);
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    bool input_player::open(const std::string& path)
+    {
+        std::ifstream file { path, std::ios::binary };
+
+        if (!file)
+        {
+            fmt::print("Can't open replay file {}\n", path);
+            return false;
+        }
+
+        const std::vector<std::uint8_t> data {
+            std::istreambuf_iterator<char> { file },
+            std::istreambuf_iterator<char> {}
+        };
+
+        if (data.size() < header_size
+            || std::memcmp(data.data(), header_magic.data(), 4) != 0)
+        {
+            fmt::print("{} isn't a replay file\n", path);
+            return false;
+        }
+
+        const std::uint64_t version = read_bytes(&data[4], 2);
+        const std::uint64_t level = read_bytes(&data[6], 2);
+
+        if (version != replay_version
+            || level > static_cast<std::uint64_t>(bench_scenario::multiball))
+        {
+            fmt::print("Replay file {} has unsupported version {}"
+                       " or level {}\n",
+                       path,
+                       version,
+                       level);
+            return false;
+        }
+
+        m_header.level = static_cast<bench_scenario>(level);
+        m_header.seed = read_bytes(&data[8], 8);
+        m_header.tick_rate = static_cast<std::uint32_t>(
+            read_bytes(&data[16], 4));
+
+        if (m_header.tick_rate == 0)
+        {
+            fmt::print("Replay file {} is corrupted\n", path);
+            return false;
+        }
+
+        std::size_t ticks_end = data.size();
+
+        m_has_footer = data.size() >= header_size + footer_size
+            && std::memcmp(&data[data.size() - 4], footer_magic.data(), 4)
+                == 0;
+
+        if (m_has_footer)
+        {
+            ticks_end -= footer_size;
+            m_world_hash = read_bytes(&data[ticks_end + 8], 8);
+        }
+
+        const std::size_t ticks_number = (ticks_end - header_size) / tick_size;
+
+        if (m_has_footer && read_bytes(&data[ticks_end], 8) != ticks_number)
+        {
+            fmt::print("Replay file {} is corrupted\n", path);
+            return false;
+        }
+
+        m_ticks.resize(ticks_number);
+        for (std::size_t i = 0; i < ticks_number; i++)
+        {
+            const std::uint8_t* tick_data = &data[header_size + i * tick_size];
+
+            m_ticks[i].dt = bits_to_float(
+                static_cast<std::uint32_t>(read_bytes(tick_data, 4)));
+            m_ticks[i].held
+                = static_cast<std::uint16_t>(read_bytes(tick_data + 4, 2));
+            m_ticks[i].pressed
+                = static_cast<std::uint16_t>(read_bytes(tick_data + 6, 2));
+            m_ticks[i].released
+                = static_cast<std::uint16_t>(read_bytes(tick_data + 8, 2));
+        }
+
+        m_position = 0;
+        m_is_open = true;
+
+        return true;
+    }
+
+    bool input_player::is_open() const noexcept
+    {
+        return m_is_open;
+    }
+
+    const replay_header& input_player::get_header() const noexcept
+    {
+        return m_header;
+    }
+
+    bool input_player::next_tick(arci::input_snapshot& input, float& dt)
+    {
+        if (m_position == m_ticks.size())
+        {
+            return false;
+        }
+
+        const tick& current = m_ticks[m_position++];
+
+        input = arci::input_snapshot {};
+        input.held = current.held;
+        input.pressed = current.pressed;
+        input.released = current.released;
+        dt = current.dt;
+
+        return true;
+    }
+
+    bool input_player::verify(const coordinator& a_coordinator) const
+    {
+        if (!m_has_footer)
+        {
+            fmt::print("Replayed {} ticks, the recording has no final state"
+                       " to compare with\n",
+                       m_position);
+            return true;
+        }
+
+        if (m_position != m_ticks.size())
+        {
+            fmt::print("Replay stopped after {} of {} ticks,"
+                       " the final state isn't checked\n",
+                       m_position,
+                       m_ticks.size());
+            return true;
+        }
+
+        const std::uint64_t hash = get_world_hash(a_coordinator);
+
+        if (hash != m_world_hash)
+        {
+            fmt::print("Replay diverged: world hash {:016x},"
+                       " recorded {:016x}\n",
+                       hash,
+                       m_world_hash);
+            return false;
+        }
+
+        fmt::print("Replayed {} ticks, the final state matches\n",
+                   m_position);
+        return true;
+    }
+}
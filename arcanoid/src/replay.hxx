@@ -0,0 +1,84 @@
+#pragma once
+
+#include "bench.hxx"
+#include "coordinator.hxx"
+#include "engine.hxx"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace arcanoid
+{
+    // Replay file layout, all numbers little-endian:
+    //   header  "ARCR", u16 version, u16 level, u64 seed, u32 tick rate;
+    //   ticks   f32 dt, u16 held, u16 pressed, u16 released keys;
+    //   footer  u64 ticks number, u64 world hash, "ARCE".
+    // The footer is written when recording stops, a file without it
+    // (e.g. after a crash) still replays but can't be verified.
+    struct replay_header
+    {
+        bench_scenario level { bench_scenario::standard };
+        // The game has no random state yet, the field keeps the format
+        // stable for when it gets some.
+        std::uint64_t seed { 0 };
+        // Steps are limited to one tick, so it has to match as well.
+        std::uint32_t tick_rate { 60 };
+    };
+
+    // Hash of every entity position and speed, equal for two runs only
+    // if they simulated exactly the same thing.
+    std::uint64_t get_world_hash(const coordinator& a_coordinator);
+
+    // Writes the input of every simulation tick, together with the time
+    // step the tick used.
+    class input_recorder
+    {
+    public:
+        bool open(const std::string& path, const replay_header& header);
+        bool is_open() const noexcept;
+
+        void add_tick(const arci::input_snapshot& input, const float dt);
+
+        // Writes the footer with the hash of the final world state.
+        void close(const coordinator& a_coordinator);
+
+    private:
+        std::ofstream m_file {};
+        std::uint64_t m_ticks {};
+    };
+
+    // Feeds a recorded input back tick by tick.
+    class input_player
+    {
+    public:
+        bool open(const std::string& path);
+        bool is_open() const noexcept;
+
+        const replay_header& get_header() const noexcept;
+
+        // Returns false when the recording is over.
+        bool next_tick(arci::input_snapshot& input, float& dt);
+
+        // Compares the world with the recorded final state and prints the
+        // outcome. Returns false on a mismatch.
+        bool verify(const coordinator& a_coordinator) const;
+
+    private:
+        struct tick
+        {
+            float dt {};
+            std::uint16_t held {};
+            std::uint16_t pressed {};
+            std::uint16_t released {};
+        };
+
+        replay_header m_header {};
+        std::vector<tick> m_ticks {};
+        std::size_t m_position {};
+        bool m_is_open { false };
+        bool m_has_footer { false };
+        std::uint64_t m_world_hash {};
+    };
+}
@@ -0,0 +1,524 @@
+#include "snapshot.hxx"
+#include "helper.hxx"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <string_view>
+
+namespace arcanoid
+{
+    // Layout of a full snapshot:
+    //   u32 magic, u64 entities number;
+    //   per entity pool: u32 count, records of u64 entity + payload;
+    //   named entities and sounds: u32 count, entries of u32 name size,
+    //   name, u64 entity or u32 sound index.
+    // A delta has the same header and per entity pool a u32 count of
+    // removed entities with their ids, then a u32 count of added or
+    // changed records with the records. Named entries are copied whole.
+    static constexpr std::uint32_t full_magic { 0x53575241 }; // "ARWS"
+    static constexpr std::uint32_t delta_magic { 0x44575241 }; // "ARWD"
+    // Resource index of a null texture or sound.
+    static constexpr std::uint32_t no_resource {
+        std::numeric_limits<std::uint32_t>::max()
+    };
+
+    enum pool_index
+    {
+        positions_pool,
+        sprites_pool,
+        transformations_pool,
+        inputs_pool,
+        collidable_entities_pool,
+        balls_pool,
+        pools_number
+    };
+
+    static constexpr std::array<std::size_t, pools_number> payload_sizes {
+        8 * sizeof(float), // position
+        sizeof(std::uint32_t), // sprite texture index
+        2 * sizeof(float), // transform2d
+        0,
+        0,
+        0,
+    };
+
+    static constexpr std::size_t get_record_size(const std::size_t pool)
+    {
+        return sizeof(entity) + payload_sizes[pool];
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    class snapshot_writer
+    {
+    public:
+        explicit snapshot_writer(std::vector<std::uint8_t>& data)
+            : m_data { data }
+        {
+            m_data.clear();
+        }
+
+        template<typename T>
+        void put(const T& value)
+        {
+            put_bytes(&value, sizeof(T));
+        }
+
+        void put_bytes(const void* bytes, const std::size_t size)
+        {
+            if (size == 0)
+            {
+                return;
+            }
+
+            const std::size_t offset = m_data.size();
+            m_data.resize(offset + size);
+            std::memcpy(m_data.data() + offset, bytes, size);
+        }
+
+        // Counts are known only after the records, so they are written as
+        // a placeholder first and patched later.
+        std::size_t put_count_placeholder()
+        {
+            const std::size_t offset = m_data.size();
+            put(std::uint32_t { 0 });
+            return offset;
+        }
+
+        void patch_count(const std::size_t offset, const std::uint32_t count)
+        {
+            std::memcpy(m_data.data() + offset, &count, sizeof(count));
+        }
+
+    private:
+        std::vector<std::uint8_t>& m_data;
+    };
+
+    class snapshot_reader
+    {
+    public:
+        explicit snapshot_reader(const std::vector<std::uint8_t>& data)
+            : m_data { data }
+        {
+        }
+
+        template<typename T>
+        T get()
+        {
+            T value {};
+            std::memcpy(&value, get_bytes(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        const std::uint8_t* get_bytes(const std::size_t size)
+        {
+            arci::CHECK(m_offset + size <= m_data.size());
+            const std::uint8_t* bytes = m_data.data() + m_offset;
+            m_offset += size;
+            return bytes;
+        }
+
+        const std::uint8_t* get_rest(std::size_t& size)
+        {
+            size = m_data.size() - m_offset;
+            return get_bytes(size);
+        }
+
+    private:
+        const std::vector<std::uint8_t>& m_data;
+        std::size_t m_offset {};
+    };
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    template<typename Component, typename PutPayload>
+    static void save_pool(snapshot_writer& out,
+                          const std::map<entity, Component>& pool,
+                          PutPayload put_payload)
+    {
+        out.put(static_cast<std::uint32_t>(pool.size()));
+
+        for (const auto& [id, component] : pool)
+        {
+            out.put(id);
+            put_payload(component);
+        }
+    }
+
+    // Merges the records into the pool: matching entities are overwritten,
+    // missing ones are inserted, the rest are erased.
+    template<typename Component, typename GetPayload>
+    static void restore_pool(snapshot_reader& in,
+                             std::map<entity, Component>& pool,
+                             GetPayload get_payload)
+    {
+        const auto count = in.get<std::uint32_t>();
+        auto it = pool.begin();
+
+        for (std::uint32_t i = 0; i < count; i++)
+        {
+            const auto id = in.get<entity>();
+
+            while (it != pool.end() && it->first < id)
+            {
+                it = pool.erase(it);
+            }
+
+            if (it == pool.end() || it->first != id)
+            {
+                it = pool.emplace_hint(it, id, Component {});
+            }
+
+            get_payload(it->second);
+            ++it;
+        }
+
+        pool.erase(it, pool.end());
+    }
+
+    template<typename Value, typename PutValue>
+    static void save_named(snapshot_writer& out,
+                           const std::map<std::string, Value>& named,
+                           PutValue put_value)
+    {
+        out.put(static_cast<std::uint32_t>(named.size()));
+
+        for (const auto& [name, value] : named)
+        {
+            out.put(static_cast<std::uint32_t>(name.size()));
+            out.put_bytes(name.data(), name.size());
+            put_value(value);
+        }
+    }
+
+    template<typename Value, typename GetValue>
+    static void restore_named(snapshot_reader& in,
+                              std::map<std::string, Value>& named,
+                              GetValue get_value)
+    {
+        const auto count = in.get<std::uint32_t>();
+        auto it = named.begin();
+
+        for (std::uint32_t i = 0; i < count; i++)
+        {
+            const auto size = in.get<std::uint32_t>();
+            const std::string_view name {
+                reinterpret_cast<const char*>(in.get_bytes(size)), size
+            };
+
+            while (it != named.end() && it->first < name)
+            {
+                it = named.erase(it);
+            }
+
+            if (it == named.end() || it->first != name)
+            {
+                it = named.emplace_hint(it, std::string { name }, Value {});
+            }
+
+            it->second = get_value();
+            ++it;
+        }
+
+        named.erase(it, named.end());
+    }
+
+    template<typename T>
+    static std::uint32_t get_resource_index(const std::vector<T*>& resources,
+                                            const T* resource)
+    {
+        if (resource == nullptr)
+        {
+            return no_resource;
+        }
+
+        const auto it = std::find(resources.begin(), resources.end(), resource);
+        arci::CHECK(it != resources.end());
+        return static_cast<std::uint32_t>(it - resources.begin());
+    }
+
+    template<typename T>
+    static T* get_resource(const std::vector<T*>& resources,
+                           const std::uint32_t index)
+    {
+        if (index == no_resource)
+        {
+            return nullptr;
+        }
+
+        arci::CHECK(index < resources.size());
+        return resources[index];
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    bool world_snapshot::is_delta() const noexcept
+    {
+        std::uint32_t magic { 0 };
+        if (data.size() >= sizeof(magic))
+        {
+            std::memcpy(&magic, data.data(), sizeof(magic));
+        }
+        return magic == delta_magic;
+    }
+
+    void save_snapshot(const coordinator& a_coordinator,
+                       const snapshot_resources& resources,
+                       world_snapshot& snapshot)
+    {
+        snapshot_writer out { snapshot.data };
+
+        out.put(full_magic);
+        out.put(entities_number);
+
+        save_pool(out, a_coordinator.positions, [&out](const position& pos) {
+            for (const glm::vec2& vertex : pos.vertices)
+            {
+                out.put(vertex.x);
+                out.put(vertex.y);
+            }
+        });
+        save_pool(out,
+                  a_coordinator.sprites,
+                  [&out, &resources](const sprite& spr) {
+                      out.put(get_resource_index(resources.textures,
+                                                 spr.texture));
+                  });
+        save_pool(out,
+                  a_coordinator.transformations,
+                  [&out](const transform2d& transform) {
+                      out.put(transform.speed_x);
+                      out.put(transform.speed_y);
+                  });
+
+        auto no_payload = [](const auto&) {};
+        save_pool(out, a_coordinator.inputs, no_payload);
+        save_pool(out, a_coordinator.collidable_entities, no_payload);
+        save_pool(out, a_coordinator.balls, no_payload);
+
+        save_named(out, a_coordinator.collidable_ids, [&out](const entity id) {
+            out.put(id);
+        });
+        save_named(out,
+                   a_coordinator.sounds,
+                   [&out, &resources](const arci::iaudio_buffer* sound) {
+                       out.put(get_resource_index(resources.sounds, sound));
+                   });
+    }
+
+    void restore_snapshot(coordinator& a_coordinator,
+                          const snapshot_resources& resources,
+                          const world_snapshot& snapshot)
+    {
+        snapshot_reader in { snapshot.data };
+
+        arci::CHECK(in.get<std::uint32_t>() == full_magic);
+        entities_number = in.get<entity>();
+
+        restore_pool(in, a_coordinator.positions, [&in](position& pos) {
+            for (glm::vec2& vertex : pos.vertices)
+            {
+                vertex.x = in.get<float>();
+                vertex.y = in.get<float>();
+            }
+        });
+        restore_pool(in,
+                     a_coordinator.sprites,
+                     [&in, &resources](sprite& spr) {
+                         spr.texture = get_resource(
+                             resources.textures,
+                             in.get<std::uint32_t>());
+                     });
+        restore_pool(in,
+                     a_coordinator.transformations,
+                     [&in](transform2d& transform) {
+                         transform.speed_x = in.get<float>();
+                         transform.speed_y = in.get<float>();
+                     });
+
+        auto no_payload = [](auto&) {};
+        restore_pool(in, a_coordinator.inputs, no_payload);
+        restore_pool(in, a_coordinator.collidable_entities, no_payload);
+        restore_pool(in, a_coordinator.balls, no_payload);
+
+        restore_named(in, a_coordinator.collidable_ids, [&in]() {
+            return in.get<entity>();
+        });
+        restore_named(in, a_coordinator.sounds, [&in, &resources]() {
+            return get_resource(resources.sounds, in.get<std::uint32_t>());
+        });
+    }
+
+    ///////////////////////////////////////////////////////////////////////////////
+
+    // Records of one pool inside a snapshot buffer.
+    struct pool_records
+    {
+        const std::uint8_t* data {};
+        std::uint32_t count {};
+        std::size_t record_size {};
+
+        entity get_id(const std::uint32_t i) const
+        {
+            // Past the end sorts after every real entity.
+            if (i == count)
+            {
+                return std::numeric_limits<entity>::max();
+            }
+
+            entity id {};
+            std::memcpy(&id, data + i * record_size, sizeof(id));
+            return id;
+        }
+
+        const std::uint8_t* get_record(const std::uint32_t i) const
+        {
+            return data + i * record_size;
+        }
+    };
+
+    static pool_records read_pool(snapshot_reader& in,
+                                  const std::size_t record_size)
+    {
+        pool_records pool {};
+        pool.count = in.get<std::uint32_t>();
+        pool.record_size = record_size;
+        pool.data = in.get_bytes(pool.count * record_size);
+        return pool;
+    }
+
+    void save_delta(const world_snapshot& base,
+                    const world_snapshot& current,
+                    world_snapshot& delta)
+    {
+        snapshot_reader base_in { base.data };
+        snapshot_reader current_in { current.data };
+        snapshot_writer out { delta.data };
+
+        arci::CHECK(base_in.get<std::uint32_t>() == full_magic);
+        arci::CHECK(current_in.get<std::uint32_t>() == full_magic);
+        base_in.get<entity>();
+
+        out.put(delta_magic);
+        out.put(current_in.get<entity>());
+
+        for (std::size_t p = 0; p < pools_number; p++)
+        {
+            const std::size_t record_size = get_record_size(p);
+            const pool_records old_pool = read_pool(base_in, record_size);
+            const pool_records new_pool = read_pool(current_in, record_size);
+
+            std::size_t count_offset = out.put_count_placeholder();
+            std::uint32_t count { 0 };
+
+            for (std::uint32_t i = 0, j = 0; i < old_pool.count; i++)
+            {
+                const entity id = old_pool.get_id(i);
+
+                while (new_pool.get_id(j) < id)
+                {
+                    j++;
+                }
+
+                if (new_pool.get_id(j) != id)
+                {
+                    out.put(id);
+                    count++;
+                }
+            }
+            out.patch_count(count_offset, count);
+
+            count_offset = out.put_count_placeholder();
+            count = 0;
+
+            for (std::uint32_t i = 0, j = 0; j < new_pool.count; j++)
+            {
+                const entity id = new_pool.get_id(j);
+
+                while (old_pool.get_id(i) < id)
+                {
+                    i++;
+                }
+
+                if (old_pool.get_id(i) != id
+                    || std::memcmp(old_pool.get_record(i),
+                                   new_pool.get_record(j),
+                                   record_size)
+                        != 0)
+                {
+                    out.put_bytes(new_pool.get_record(j), record_size);
+                    count++;
+                }
+            }
+            out.patch_count(count_offset, count);
+        }
+
+        std::size_t named_size {};
+        const std::uint8_t* named = current_in.get_rest(named_size);
+        out.put_bytes(named, named_size);
+    }
+
+    void apply_delta(const world_snapshot& base,
+                     const world_snapshot& delta,
+                     world_snapshot& current)
+    {
+        snapshot_reader base_in { base.data };
+        snapshot_reader delta_in { delta.data };
+        snapshot_writer out { current.data };
+
+        arci::CHECK(base_in.get<std::uint32_t>() == full_magic);
+        arci::CHECK(delta_in.get<std::uint32_t>() == delta_magic);
+        base_in.get<entity>();
+
+        out.put(full_magic);
+        out.put(delta_in.get<entity>());
+
+        for (std::size_t p = 0; p < pools_number; p++)
+        {
+            const std::size_t record_size = get_record_size(p);
+            const pool_records old_pool = read_pool(base_in, record_size);
+            const pool_records removed = read_pool(delta_in, sizeof(entity));
+            const pool_records changed = read_pool(delta_in, record_size);
+
+            const std::size_t count_offset = out.put_count_placeholder();
+            std::uint32_t count { 0 };
+            std::uint32_t i { 0 };
+            std::uint32_t r { 0 };
+            std::uint32_t c { 0 };
+
+            while (i < old_pool.count || c < changed.count)
+            {
+                const entity old_id = old_pool.get_id(i);
+                const entity changed_id = changed.get_id(c);
+
+                if (changed_id <= old_id)
+                {
+                    out.put_bytes(changed.get_record(c), record_size);
+                    count++;
+                    c++;
+                    i += changed_id == old_id ? 1 : 0;
+                    continue;
+                }
+
+                while (removed.get_id(r) < old_id)
+                {
+                    r++;
+                }
+
+                if (removed.get_id(r) != old_id)
+                {
+                    out.put_bytes(old_pool.get_record(i), record_size);
+                    count++;
+                }
+                i++;
+            }
+            out.patch_count(count_offset, count);
+        }
+
+        std::size_t named_size {};
+        const std::uint8_t* named = delta_in.get_rest(named_size);
+        out.put_bytes(named, named_size);
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "coordinator.hxx"
+#include "engine.hxx"
+
+#include <cstdint>
+#include <vector>
+
+namespace arcanoid
+{
+    // Texture and sound tables snapshots refer to by index. Snapshots hold
+    // no pointers, so they stay valid as long as the tables do. A null
+    // texture or sound is saved as a reserved index and restored as null.
+    struct snapshot_resources
+    {
+        std::vector<arci::itexture*> textures {};
+        std::vector<arci::iaudio_buffer*> sounds {};
+    };
+
+    // The whole coordinator state in one contiguous buffer, component
+    // pools one after another, every pool sorted by entity. Data is in
+    // the native byte order, snapshots aren't meant to move between
+    // machines.
+    //
+    // A delta snapshot keeps only the records which differ from a base
+    // snapshot. Buffers are reused, so taking snapshots of a world of the
+    // same size doesn't allocate.
+    struct world_snapshot
+    {
+        bool is_delta() const noexcept;
+
+        std::vector<std::uint8_t> data {};
+    };
+
+    void save_snapshot(const coordinator& a_coordinator,
+                       const snapshot_resources& resources,
+                       world_snapshot& snapshot);
+
+    // Entities existing in both the world and the snapshot are updated in
+    // place, so restoring a world into a recent state of itself (rewind,
+    // rollback) doesn't allocate.
+    void restore_snapshot(coordinator& a_coordinator,
+                          const snapshot_resources& resources,
+                          const world_snapshot& snapshot);
+
+    // `base` and `current` should be full snapshots.
+    void save_delta(const world_snapshot& base,
+                    const world_snapshot& current,
+                    world_snapshot& delta);
+
+    // Rebuilds the full snapshot `delta` was taken from.
+    void apply_delta(const world_snapshot& base,
+                     const world_snapshot& delta,
+                     world_snapshot& current);
+}
@@ -0,0 +1,103 @@
+// Checks of the engine IMA-ADPCM format (see engine/include/adpcm.hxx):
+// streams the loader has to accept or reject and the round trip of
+// encoded samples.
+
+#include "adpcm.hxx"
+
+#include <fmt/core.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+    int failures_number { 0 };
+
+    void check(const bool condition, const std::string& message)
+    {
+        if (!condition)
+        {
+            fmt::print(stderr, "adpcm-test: {}\n", message);
+            ++failures_number;
+        }
+    }
+
+    std::vector<std::int16_t> get_tone(const std::size_t frames,
+                                       const std::uint16_t channels)
+    {
+        std::vector<std::int16_t> result(frames * channels);
+        for (std::size_t i = 0; i < result.size(); ++i)
+        {
+            result[i] = static_cast<std::int16_t>(
+                8000.0 * std::sin(static_cast<double>(i / channels) * 0.05));
+        }
+        return result;
+    }
+}
+
+int main()
+{
+    using namespace arci::adpcm;
+
+    header stream_header {};
+
+    // Nothing to decode, and a looped voice would never advance.
+    const std::vector<std::uint8_t> empty = encode(nullptr, 0, 1, 48000);
+    check(!parse_header(empty.data(), empty.size(), stream_header),
+          "an empty stream is accepted");
+
+    // One block and a bit, so the last block is a short one.
+    const std::size_t frames { block_frames + 100 };
+    const std::uint16_t channels { 2 };
+    const std::vector<std::int16_t> tone = get_tone(frames, channels);
+    std::vector<std::uint8_t> encoded
+        = encode(tone.data(), frames, channels, 48000);
+
+    check(parse_header(encoded.data(), encoded.size(), stream_header),
+          "a valid stream is rejected");
+    check(stream_header.frames == frames && stream_header.blocks == 2,
+          "wrong frames or blocks in the header");
+    check(get_block_frames(stream_header, 1) == 100,
+          "wrong frames in the last block");
+
+    check(!parse_header(encoded.data(), encoded.size() - 1, stream_header),
+          "a truncated stream is accepted");
+    check(!parse_header(encoded.data(), sizeof(header) - 1, stream_header),
+          "a truncated header is accepted");
+
+    std::vector<std::uint8_t> bad_magic = encoded;
+    bad_magic[0] = 'X';
+    check(!parse_header(bad_magic.data(), bad_magic.size(), stream_header),
+          "a stream with a wrong magic is accepted");
+
+    // The round trip keeps the signal well above the noise.
+    parse_header(encoded.data(), encoded.size(), stream_header);
+    std::vector<std::int16_t> decoded(block_frames * channels);
+    double signal { 0.0 }, noise { 0.0 };
+    for (std::size_t block = 0; block < stream_header.blocks; ++block)
+    {
+        const std::size_t block_frames_number
+            = decode_block(stream_header,
+                           encoded.data() + sizeof(header),
+                           block,
+                           decoded.data());
+        check(block_frames_number == get_block_frames(stream_header, block),
+              fmt::format("wrong frames decoded from block {}", block));
+
+        for (std::size_t i = 0; i < block_frames_number * channels; ++i)
+        {
+            const double expected
+                = tone[block * block_frames * channels + i];
+            const double error = expected - decoded[i];
+            signal += expected * expected;
+            noise += error * error;
+        }
+    }
+    const double snr = 10.0 * std::log10(signal / noise);
+    check(snr > 25.0, fmt::format("round trip SNR is {:.1f} dB", snr));
+
+    return failures_number == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,275 @@
+// Converts a 16-bit PCM WAVE file into the engine IMA-ADPCM format
+// (see engine/include/adpcm.hxx) and reports how much memory it saves
+// and how much it costs to decode.
+//
+// Usage: wav-to-adpcm <input.wav> <output.adpcm> [sample rate]
+
+#include "adpcm.hxx"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct pcm_sound
+    {
+        std::uint32_t sample_rate {};
+        std::uint16_t channels {};
+        std::vector<std::int16_t> samples {};
+    };
+
+    std::uint32_t read_u32(const std::uint8_t* data)
+    {
+        return data[0] | (data[1] << 8) | (data[2] << 16)
+            | (static_cast<std::uint32_t>(data[3]) << 24);
+    }
+
+    std::uint16_t read_u16(const std::uint8_t* data)
+    {
+        return static_cast<std::uint16_t>(data[0] | (data[1] << 8));
+    }
+
+    [[noreturn]] void fail(const std::string& message)
+    {
+        fmt::print(stderr, "wav-to-adpcm: {}\n", message);
+        std::exit(EXIT_FAILURE);
+    }
+
+    pcm_sound load_wav(const char* path)
+    {
+        std::ifstream file { path, std::ios::binary };
+
+        if (!file.is_open())
+        {
+            fail(fmt::format("can't open '{}'", path));
+        }
+
+        const std::vector<std::uint8_t> data {
+            std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>()
+        };
+
+        if (data.size() < 12
+            || std::memcmp(data.data(), "RIFF", 4) != 0
+            || std::memcmp(data.data() + 8, "WAVE", 4) != 0)
+        {
+            fail(fmt::format("'{}' is not a WAVE file", path));
+        }
+
+        pcm_sound result {};
+        bool format_found { false };
+        std::size_t offset { 12 };
+
+        while (offset + 8 <= data.size())
+        {
+            const std::uint8_t* chunk = data.data() + offset;
+            const std::uint32_t chunk_size = read_u32(chunk + 4);
+            const std::uint8_t* body = chunk + 8;
+
+            if (offset + 8 + chunk_size > data.size())
+            {
+                fail(fmt::format("'{}' is truncated", path));
+            }
+
+            if (std::memcmp(chunk, "fmt ", 4) == 0 && chunk_size >= 16)
+            {
+                const std::uint16_t format_tag = read_u16(body);
+                const std::uint16_t bits = read_u16(body + 14);
+
+                if (format_tag != 1 || bits != 16)
+                {
+                    fail(fmt::format("'{}' should be 16-bit PCM", path));
+                }
+
+                result.channels = read_u16(body + 2);
+                result.sample_rate = read_u32(body + 4);
+                format_found = true;
+            }
+            else if (std::memcmp(chunk, "data", 4) == 0)
+            {
+                if (!format_found)
+                {
+                    fail(fmt::format("'{}' has data before format", path));
+                }
+
+                result.samples.resize(chunk_size / sizeof(std::int16_t));
+                for (std::size_t i = 0; i < result.samples.size(); ++i)
+                {
+                    result.samples[i] = static_cast<std::int16_t>(
+                        read_u16(body + i * sizeof(std::int16_t)));
+                }
+            }
+
+            // Chunks are padded to an even size.
+            offset += 8 + chunk_size + (chunk_size & 1);
+        }
+
+        if (!format_found || result.samples.empty() || result.channels == 0)
+        {
+            fail(fmt::format("'{}' has no PCM data", path));
+        }
+
+        return result;
+    }
+
+    // Linear interpolation is enough for sound effects and keeps the tool
+    // free of dependencies.
+    pcm_sound resample(const pcm_sound& sound, const std::uint32_t sample_rate)
+    {
+        if (sound.sample_rate == sample_rate)
+        {
+            return sound;
+        }
+
+        const std::size_t channels = sound.channels;
+        const std::size_t in_frames = sound.samples.size() / channels;
+        const std::size_t out_frames = static_cast<std::size_t>(
+            static_cast<std::uint64_t>(in_frames) * sample_rate
+            / sound.sample_rate);
+        const double ratio = static_cast<double>(sound.sample_rate)
+            / sample_rate;
+
+        pcm_sound result { sample_rate, sound.channels, {} };
+        result.samples.resize(out_frames * channels);
+
+        for (std::size_t frame = 0; frame < out_frames; ++frame)
+        {
+            const double position = frame * ratio;
+            const std::size_t left = static_cast<std::size_t>(position);
+            const std::size_t right = std::min(left + 1, in_frames - 1);
+            const double tau = position - left;
+
+            for (std::size_t channel = 0; channel < channels; ++channel)
+            {
+                const double value
+                    = sound.samples[left * channels + channel] * (1.0 - tau)
+                    + sound.samples[right * channels + channel] * tau;
+                result.samples[frame * channels + channel]
+                    = static_cast<std::int16_t>(std::lround(value));
+            }
+        }
+
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        fmt::print(stderr,
+                   "Usage: {} <input.wav> <output.adpcm> [sample rate]\n",
+                   argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const std::uint32_t sample_rate = argc > 3
+        ? static_cast<std::uint32_t>(std::strtoul(argv[3], nullptr, 10))
+        : 48000u;
+
+    if (sample_rate == 0)
+    {
+        fail("invalid sample rate");
+    }
+
+    const pcm_sound source = load_wav(argv[1]);
+    const pcm_sound sound = resample(source, sample_rate);
+    const std::size_t frames = sound.samples.size() / sound.channels;
+
+    if (frames == 0)
+    {
+        fail(fmt::format("'{}' has no samples", argv[1]));
+    }
+
+    const std::vector<std::uint8_t> encoded = arci::adpcm::encode(
+        sound.samples.data(),
+        frames,
+        sound.channels,
+        sound.sample_rate);
+
+    std::ofstream output { argv[2], std::ios::binary | std::ios::trunc };
+    if (!output.is_open())
+    {
+        fail(fmt::format("can't open '{}' for writing", argv[2]));
+    }
+    output.write(reinterpret_cast<const char*>(encoded.data()),
+                 static_cast<std::streamsize>(encoded.size()));
+    output.close();
+    if (!output.good())
+    {
+        fail(fmt::format("error on writing '{}'", argv[2]));
+    }
+
+    // Decode everything back: it gives both the decode cost the mixer
+    // pays per voice and the quality loss of the conversion.
+    arci::adpcm::header stream_header {};
+    if (!arci::adpcm::parse_header(encoded.data(),
+                                   encoded.size(),
+                                   stream_header))
+    {
+        fail("produced an invalid stream");
+    }
+
+    const std::uint8_t* blocks = encoded.data() + sizeof(arci::adpcm::header);
+    std::vector<std::int16_t> decoded(
+        static_cast<std::size_t>(stream_header.blocks)
+        * arci::adpcm::block_frames
+        * stream_header.channels);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t block = 0; block < stream_header.blocks; ++block)
+    {
+        arci::adpcm::decode_block(
+            stream_header,
+            blocks,
+            block,
+            decoded.data()
+                + block * arci::adpcm::block_frames * stream_header.channels);
+    }
+    const auto finish = std::chrono::steady_clock::now();
+
+    double signal { 0.0 }, noise { 0.0 };
+    for (std::size_t i = 0; i < sound.samples.size(); ++i)
+    {
+        const double expected = sound.samples[i];
+        const double error = expected - decoded[i];
+        signal += expected * expected;
+        noise += error * error;
+    }
+
+    const double decode_ns = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start)
+            .count());
+    const double seconds_of_audio = static_cast<double>(frames)
+        / sound.sample_rate;
+    const std::size_t pcm_bytes = sound.samples.size()
+        * sizeof(std::int16_t);
+
+    fmt::print("{}: {} Hz -> {} Hz, {} channel(s), {:.2f} s\n",
+               argv[1],
+               source.sample_rate,
+               sound.sample_rate,
+               sound.channels,
+               seconds_of_audio);
+    fmt::print("  memory: {} KiB PCM -> {} KiB ADPCM ({:.2f}x smaller)\n",
+               pcm_bytes / 1024,
+               encoded.size() / 1024,
+               static_cast<double>(pcm_bytes) / encoded.size());
+    fmt::print("  quality: {:.1f} dB SNR\n",
+               noise > 0.0 ? 10.0 * std::log10(signal / noise) : 99.0);
+    fmt::print("  decode: {:.2f} ns per frame, {:.2f} us per 10 ms voice\n",
+               decode_ns / frames,
+               decode_ns / seconds_of_audio / 100.0 / 1000.0);
+
+    return EXIT_SUCCESS;
+}